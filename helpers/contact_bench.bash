@@ -0,0 +1,41 @@
+#!/bin/bash
+# Run the same parameters with contact = virtual and contact = segment and
+# show, for each run, the wall time and the last line of the shape file
+# (step, then mean, deviation, minimum and maximum of P0 and of the area).
+#
+# Usage: ./contact_bench.bash parameters_file [runs] [superboids]
+
+if [ -z "$1" ]
+then
+    echo "please type a parameters file"
+    exit 1
+fi
+
+parameters=$(readlink -f "$1")
+runs=${2:-3}
+superboids=$(readlink -f "${3:-./superboids}")
+
+workdir=$(mktemp -d)
+cd "$workdir" || exit 1
+
+for contact in virtual segment
+do
+    grep -v "^ *contact *=" "$parameters" > "$contact.txt"
+    echo "contact = $contact" >> "$contact.txt"
+
+    for run in $(seq "$runs")
+    do
+	begin=$(date +%s%N)
+	"$superboids" -param "$contact.txt" -shape > /dev/null 2>&1 || exit $?
+	end=$(date +%s%N)
+
+	shape=$(ls *_shape.dat | sort -n | tail -n 1)
+	echo -e "$contact\t$(( (end - begin) / 1000000 )) ms\t$(tail -n 1 "$shape" | cut -f 1-9)"
+	rm -f ./*.dat ./*.bin
+    done
+done
+
+cd - > /dev/null
+rm -rf "$workdir"
+
+exit 0
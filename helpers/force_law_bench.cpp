@@ -0,0 +1,154 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+// Cost per evaluation of the tangent force law, with the recursion over the
+// plastic limits that built a vector of limits and returned a valarray per
+// call, and with the ForceLaw breakpoints, plus the largest difference
+// between the two. The new kernel calls getFiniteForce of
+// src/elastic_plastic.hpp; the old one is a copy of the code it replaced.
+//
+// g++ -std=c++14 -O3 -I../src force_law_bench.cpp -o force_law_bench
+// ./force_law_bench [evaluations]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <valarray>
+#include <vector>
+
+#include "elastic_plastic.hpp"
+
+static const unsigned REPETITIONS = 20u;
+
+// Tangent law of the default parameters, for 19 miniboids per superboid.
+static const real ARC       = 6.28318531f * 1.0f / 18.0f;
+static const real REQ       = ARC;
+static const real BEGIN     = 1.2f * ARC;
+static const real END       = 1.5f * ARC;
+static const real BETA_LOW  = 0.5f;
+static const real BETA_HIGH = 1.5f;
+
+struct Distance {
+  real module;
+  real cosine;
+  real sine;
+};
+
+static std::valarray<real>
+    getOldForce(Distance dist, const real beta, const real rEq,
+                const std::vector<real> &transitions) {
+  real &module = dist.module;
+  std::valarray<real> force(0.0f, 2u);
+
+  if (transitions.size() == 0 || module <= transitions[0u] + 1.0e-6f) {
+    const real scalar = (1.0f - module / rEq) * beta;
+    if (std::isfinite(scalar)) {
+      force  = {dist.cosine, dist.sine};
+      force *= scalar;
+      return force;
+    }
+  } else
+    for (std::size_t index = 1u; index < transitions.size(); ++index) {
+      if (index % 2 == 1) {
+        if (module <= transitions[index]) {
+          module = transitions[index - 1];
+          return getOldForce(dist, beta, rEq, transitions);
+        }
+      } else {
+        if (module <= transitions[index] + 1.0e-6f) {
+          const real d   = transitions[index - 1] - transitions[index];
+          const real dif = 1.0f - (module - d) / rEq;
+          if (std::isfinite(dif)) {
+            force  = {dist.cosine, dist.sine};
+            force *= dif;
+          }
+          return force;
+        }
+      }
+    }
+
+  dist.module = transitions.back();
+
+  return getOldForce(dist, beta, rEq, transitions);
+}
+
+// As the twist forces were summed: limits built once per call site.
+static void
+    oldKernel(const std::vector<Distance> &distances,
+              const std::vector<real> &betas, std::vector<real> &forces) {
+  for (std::size_t n = 0u; n < distances.size(); ++n) {
+    const std::vector<real> limits({BEGIN, END});
+    const std::valarray<real> force
+        = -getOldForce(distances[n], betas[n], REQ, limits);
+    forces[2u * n]      = force[0u];
+    forces[2u * n + 1u] = force[1u];
+  }
+
+  return;
+}
+
+static void
+    newKernel(const std::vector<Distance> &distances,
+              const std::vector<real> &betas, std::vector<real> &forces) {
+  // As Parameters::setForceLaws sets the tangent law.
+  const ForceLaw law({BEGIN + 1.0e-6f, BEGIN});
+  for (std::size_t n = 0u; n < distances.size(); ++n) {
+    const real scalar
+        = -getFiniteForce(law, distances[n].module, betas[n], REQ);
+    forces[2u * n]      = scalar * distances[n].cosine;
+    forces[2u * n + 1u] = scalar * distances[n].sine;
+  }
+
+  return;
+}
+
+int
+    main(int argc, char **argv) {
+  const std::size_t evaluations = argc > 1 ? std::atoi(argv[1]) : 200000u;
+
+  // Ring edges from compressed to beyond the plastic end.
+  std::default_random_engine engine(42u);
+  std::uniform_real_distribution<real> module(0.5f * ARC, 2.0f * ARC);
+  std::uniform_real_distribution<real> angle(-3.14159265f, 3.14159265f);
+  std::uniform_real_distribution<real> beta(BETA_LOW, BETA_HIGH);
+  std::vector<Distance> distances(evaluations);
+  std::vector<real> betas(evaluations);
+  for (std::size_t n = 0u; n < evaluations; ++n) {
+    const real a = angle(engine);
+    distances[n] = Distance({module(engine), std::cos(a), std::sin(a)});
+    betas[n]     = beta(engine);
+  }
+
+  std::vector<real> oldForces(2u * evaluations);
+  std::vector<real> newForces(2u * evaluations);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (unsigned r = 0u; r < REPETITIONS; ++r)
+    oldKernel(distances, betas, oldForces);
+  const double oldTime = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+
+  begin = std::chrono::steady_clock::now();
+  for (unsigned r = 0u; r < REPETITIONS; ++r)
+    newKernel(distances, betas, newForces);
+  const double newTime = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+
+  real error = 0.0f;
+  for (std::size_t n = 0u; n < oldForces.size(); ++n)
+    error = std::fmax(error, std::fabs(oldForces[n] - newForces[n]));
+
+  const double perEvaluation = 1.0 / (REPETITIONS * evaluations);
+  std::cout << "old:\t" << oldTime * perEvaluation << " ns/evaluation"
+            << std::endl
+            << "new:\t" << newTime * perEvaluation << " ns/evaluation"
+            << std::endl
+            << "largest difference:\t" << error << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,173 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+// Cost per peripheral miniboid of the angles of the twist force, before and
+// after Distance::getTangentArray and angleBetween dropped the
+// trigonometric calls, plus the largest difference between the two. The new
+// kernel calls the functions of src/Distance.hpp; the old one is a copy of
+// the code they replaced.
+//
+// g++ -std=c++14 -O3 -I../src twist_bench.cpp -o twist_bench
+// ./twist_bench [cells]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "Distance.hpp"
+
+// Declared in parameters.hpp, defined in parameters.cpp, which is not linked.
+const real PI         = 3.14159265f;
+const real TWO_PI     = 6.28318531f;
+const real HALF_PI    = 1.57079633f;
+const dimension_int X = 0u;
+const dimension_int Y = 1u;
+
+static const unsigned PERIPHERALS = 18u;  // MINIBOIDS_PER_SUPERBOID - 1.
+static const unsigned REPETITIONS = 20u;
+
+// Unit vector from a peripheral miniboid to the nucleus.
+struct Direction {
+  real cosine;
+  real sine;
+};
+
+// Outputs of both kernels, for one twist neighbor.
+struct Twist {
+  real angle;  // Between the two radial directions.
+  real tangentX;
+  real tangentY;
+};
+
+static real
+    oldAssertAngle(real angle) {
+  while (angle < -PI)
+    angle += TWO_PI;
+  while (angle > PI)
+    angle -= TWO_PI;
+  return angle;
+}
+
+static real
+    oldAngleBetween(const real phi1, const real phi2) {
+  const real difference = phi2 - phi1;
+  const real absolute   = std::fabs(difference);
+
+  if (absolute <= PI)
+    return oldAssertAngle(difference);
+  else
+    return oldAssertAngle((difference > 0.0f ? 1.0f : -1.0f)
+                       * (absolute - TWO_PI));
+}
+
+static real
+    getAngle(const Direction &d) {
+  real angle = std::atan2(d.sine, d.cosine);
+  if (angle < -PI)
+    angle += TWO_PI;
+  return angle;
+}
+
+// Radial angles set once per miniboid by reset, then, for each of the two
+// twist neighbors, angleBetween and the tangent from atan2, cos and sin.
+static void
+    oldKernel(const std::vector<Direction> &directions,
+              std::vector<real> &angles, std::vector<Twist> &twists) {
+  for (std::size_t i = 0u; i < directions.size(); ++i)
+    angles[i] = getAngle(directions[i]);
+
+  for (std::size_t cell = 0u; cell < directions.size(); cell += PERIPHERALS)
+    for (unsigned i = 0u; i < PERIPHERALS; ++i)
+      for (unsigned side = 0u; side < 2u; ++side) {
+        const unsigned j = (i + (side == 0u ? 1u : PERIPHERALS - 1u))
+                           % PERIPHERALS;
+        Twist &twist = twists[2u * (cell + i) + side];
+        twist.angle  = oldAngleBetween(angles[cell + i], angles[cell + j]);
+        const real tangentAngle = getAngle(directions[cell + i]) + HALF_PI;
+        twist.tangentX          = std::cos(tangentAngle);
+        twist.tangentY          = std::sin(tangentAngle);
+      }
+
+  return;
+}
+
+// Cross and dot products for the angle, a quarter turn for the tangent.
+static void
+    newKernel(const std::vector<Direction> &directions,
+              std::vector<Twist> &twists) {
+  for (std::size_t cell = 0u; cell < directions.size(); cell += PERIPHERALS)
+    for (unsigned i = 0u; i < PERIPHERALS; ++i) {
+      const Direction &d1 = directions[cell + i];
+      Distance radial;
+      radial.cosine      = d1.cosine;
+      radial.sine        = d1.sine;
+      const Vec2 tangent = radial.getTangentArray();
+      for (unsigned side = 0u; side < 2u; ++side) {
+        const unsigned j = (i + (side == 0u ? 1u : PERIPHERALS - 1u))
+                           % PERIPHERALS;
+        const Direction &d2 = directions[cell + j];
+        Twist &twist        = twists[2u * (cell + i) + side];
+        twist.angle = angleBetween(d1.cosine, d1.sine, d2.cosine, d2.sine);
+        twist.tangentX = tangent[X];
+        twist.tangentY = tangent[Y];
+      }
+    }
+
+  return;
+}
+
+int
+    main(int argc, char **argv) {
+  const std::size_t cells     = argc > 1 ? std::atoi(argv[1]) : 10000u;
+  const std::size_t particles = cells * PERIPHERALS;
+
+  // Roughly round cells: directions spread around the nucleus, with noise.
+  std::default_random_engine engine(42u);
+  std::uniform_real_distribution<real> noise(-0.2f, 0.2f);
+  std::vector<Direction> directions(particles);
+  for (std::size_t n = 0u; n < particles; ++n) {
+    const real angle
+        = TWO_PI * (n % PERIPHERALS) / PERIPHERALS + noise(engine) - PI;
+    directions[n] = Direction{std::cos(angle), std::sin(angle)};
+  }
+
+  std::vector<real> angles(particles);
+  std::vector<Twist> oldTwists(2u * particles);
+  std::vector<Twist> newTwists(2u * particles);
+
+  auto begin = std::chrono::steady_clock::now();
+  for (unsigned r = 0u; r < REPETITIONS; ++r)
+    oldKernel(directions, angles, oldTwists);
+  const double oldTime = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+
+  begin = std::chrono::steady_clock::now();
+  for (unsigned r = 0u; r < REPETITIONS; ++r)
+    newKernel(directions, newTwists);
+  const double newTime = std::chrono::duration<double, std::nano>(
+                             std::chrono::steady_clock::now() - begin)
+                             .count();
+
+  real angleError = 0.0f, tangentError = 0.0f;
+  for (std::size_t n = 0u; n < oldTwists.size(); ++n) {
+    angleError = std::fmax(
+        angleError, std::fabs(oldTwists[n].angle - newTwists[n].angle));
+    tangentError = std::fmax(
+        tangentError,
+        std::fmax(std::fabs(oldTwists[n].tangentX - newTwists[n].tangentX),
+                  std::fabs(oldTwists[n].tangentY - newTwists[n].tangentY)));
+  }
+
+  const double perParticle = 1.0 / (REPETITIONS * particles);
+  std::cout << "old:\t" << oldTime * perParticle << " ns/particle" << std::endl
+            << "new:\t" << newTime * perParticle << " ns/particle" << std::endl
+            << "largest difference:\t" << angleError << " rad (angle)\t"
+            << tangentError << " (tangent)" << std::endl;
+
+  return 0;
+}
@@ -4,11 +4,11 @@
 
 #include "Box.hpp"
 
-#include <valarray>
 #include <vector>
 
 #include "Miniboid.hpp"
 #include "Superboid.hpp"
+#include "ThreadPool.hpp"
 
 namespace boxID {
   static box_int south(const box_int centralBoxID) {
@@ -58,6 +58,12 @@ namespace boxID {
 }  // namespace boxID
 
 box_int Box::_totalBoxesCount(0u);
+std::vector<const Miniboid *> Box::_miniboids;
+std::vector<const VirtualMiniboid *> Box::_virtuals;
+std::vector<const MembraneSegment *> Box::_segments;
+bool Box::_hasVirtuals(false);
+bool Box::_hasSegments(false);
+std::vector<std::vector<std::size_t>> Box::_counts;
 
 /******************
  *  Box methods:  *
@@ -69,8 +75,9 @@ Box::Box(void)
     , inEdge(Box::getIsInEdge(ID))
     , /* Construct boolean. */
     neighbors(9u, nullptr)
-    ,           /* Construct a vector with 9 null pointer elements. */
-    miniboids() /* Construct superboids as a empty list. */
+    ,        /* Construct a vector with 9 null pointer elements. */
+    _begin{0u, 0u, 0u}
+    , _end{0u, 0u, 0u} /* Construct as an empty box. */
 {
 #ifdef DEBUG
   if (_totalBoxesCount > parameters().BOXES) {
@@ -83,38 +90,75 @@ Box::Box(void)
   return;
 }
 
-box_int
-    Box::getBoxID(std::valarray<real> position) /* Parameter by copy. */
-{
+// Box coordinate of a position component.
+static inline box_int
+    getBoxCoordinate(const real component, const real boxSizeInverse) {
+  const real normalized
+      = (component + 0.5f * parameters().RANGE) /* Translate */
+        * boxSizeInverse;                         /* Normalize */
+  const box_int truncated = static_cast<box_int>(normalized);
+  return normalized == parameters().BOXES_IN_EDGE ? truncated - 1u : truncated;
+}
+
+static inline real
+    getBoxSizeInverse(void) {
   static const real BOX_SIZE_INVERSE
       = static_cast<real>(parameters().BOXES_IN_EDGE)
         / parameters().RANGE;  // 1/BOX_SIZE
+  return BOX_SIZE_INVERSE;
+}
+
+// Box ID from box coordinates, specialized on the number of dimensions.
+template<dimension_int N, typename Coordinate>
+static inline box_int
+    getBoxIDOf(const Coordinate &coordinate) {
+  box_int tmpBoxID(0u);
+  box_int power(1u);
+  for (dimension_int dim = 0u; dim < N; ++dim) {
+    tmpBoxID += coordinate(dim) * power;
+    power *= parameters().BOXES_IN_EDGE;
+  }
 
-  position += 0.5f * parameters().RANGE; /* Translate */
-  position *= BOX_SIZE_INVERSE;          /* Normalize */
+  return tmpBoxID;
+}
+
+box_int
+    Box::getBoxID(const Vec2 &position) {
+  const real BOX_SIZE_INVERSE = getBoxSizeInverse();
+  return getBoxIDOf<Vec2::DIMENSIONS>([&](const dimension_int dim) {
+    return getBoxCoordinate(position[dim], BOX_SIZE_INVERSE);
+  });
+}
 
-  std::vector<box_int> truncated;
-  for (dimension_int dimension = 0u; dimension < parameters().DIMENSIONS;
-       ++dimension)
-    truncated.push_back(static_cast<box_int>(position[dimension]));
+box_int
+    Box::getBoxID(const std::size_t particleID) {
+  return getBoxIDOf<Vec2::DIMENSIONS>([&](const dimension_int dim) {
+    return Particles::getBoxCoordinate(dim)[particleID];
+  });
+}
 
-  box_int tmpBoxID(0u);
-  for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim) {
-    box_int sum = truncated[dim];
-    for (dimension_int power = 0u; power < dim; ++power)
-      sum *= parameters().BOXES_IN_EDGE;
-    tmpBoxID += sum;
+void
+    Box::locate(std::vector<Box> &boxes, Superboid &superboid) {
+  // One pass per dimension over the contiguous positions of the cell; the
+  // loop has no branch and vectorizes.
+  const real BOX_SIZE_INVERSE = getBoxSizeInverse();
+  const std::size_t first     = Miniboid::getParticleID(superboid, 0u);
+  const mini_int n            = parameters().MINIBOIDS_PER_SUPERBOID;
+  for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim) {
+    const real *position = Particles::get(ParticleField::POSITION, dim) + first;
+    box_int *coordinate  = Particles::getBoxCoordinate(dim) + first;
+    for (mini_int i = 0u; i < n; ++i)
+      coordinate[i] = getBoxCoordinate(position[i], BOX_SIZE_INVERSE);
   }
 
-  for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim)
-    if (position[dim] == parameters().BOXES_IN_EDGE) {
-      box_int sum = 1;
-      for (dimension_int power = 0u; power < dim; ++power)
-        sum *= parameters().BOXES_IN_EDGE;
-      tmpBoxID -= sum;
-    }
+  // Miniboids that stayed in their box keep it.
+  for (auto &mini : superboid.miniboids) {
+    const box_int boxID = getBoxID(first + mini.ID);
+    if (mini.getBoxPtr() == nullptr || mini.getBox().ID != boxID)
+      mini.setBox(&boxes[boxID]);
+  }
 
-  return tmpBoxID;
+  return;
 }
 
 bool
@@ -158,12 +202,200 @@ void
   return;
 }
 
+// Part [begin, end) of size items done by thread THREAD_ID of threadsNo.
+static inline void
+    getShare(const thread_int THREAD_ID, const thread_int threadsNo,
+             const std::size_t size, std::size_t &begin, std::size_t &end) {
+  begin = size * THREAD_ID / threadsNo;
+  end   = size * (THREAD_ID + 1u) / threadsNo;
+
+  return;
+}
+
+// Set the boxes touched by a segment from the box coordinates of its ends,
+// which must be located already.
+static void
+    setBoxes(MembraneSegment &segment) {
+  const box_int B            = parameters().BOXES_IN_EDGE;
+  const std::size_t firstID  = Miniboid::getParticleID(
+      segment.first->superboid, segment.first->ID);
+  const std::size_t secondID = Miniboid::getParticleID(
+      segment.second->superboid, segment.second->ID);
+  for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim) {
+    const box_int first  = Particles::getBoxCoordinate(dim)[firstID];
+    const box_int second = Particles::getBoxCoordinate(dim)[secondID];
+    const real edge      = Distance::getMinimalImage(
+        segment.second->position[dim] - segment.first->position[dim]);
+    if (edge >= 0.0f) {
+      segment.firstBox[dim] = first;
+      segment.boxesNo[dim]  = (second + B - first) % B + 1u;
+    } else {
+      segment.firstBox[dim] = second;
+      segment.boxesNo[dim]  = (first + B - second) % B + 1u;
+    }
+  }
+
+  return;
+}
+
+template<typename Function>
+static inline void
+    forEachBox(const MembraneSegment &segment, const Function &function) {
+  const box_int B = parameters().BOXES_IN_EDGE;
+  for (box_int i = 0u; i < segment.boxesNo[X]; ++i)
+    for (box_int j = 0u; j < segment.boxesNo[Y]; ++j) {
+      const box_int coordinates[]
+          = {(segment.firstBox[X] + i) % B, (segment.firstBox[Y] + j) % B};
+      function(getBoxIDOf<Vec2::DIMENSIONS>(
+          [&](const dimension_int dim) { return coordinates[dim]; }));
+    }
+
+  return;
+}
+
+template<typename Run>
 void
-    Box::append(Miniboid &mini) {
-  if (mini.superboid.isActivated() == true) {
-    this->miniboids.push_front(&mini);
-    mini.setBox(this);
+    Box::fill(const thread_int threadsNo, const Run &run,
+              std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+              const BoxLayer layer) {
+  // Every thread sorts a contiguous share of the activated superboids, so
+  // the order inside a box does not depend on the number of threads.
+  const std::vector<super_int> &activated = Superboid::activated();
+  const uint16_t l                        = static_cast<uint16_t>(layer);
+  _counts.resize(threadsNo);
+
+  // Locate the miniboids and count them per box and thread:
+  run([&](const thread_int THREAD_ID) {
+    std::vector<std::size_t> &counts = _counts[THREAD_ID];
+    counts.assign(boxes.size(), 0u);
+
+    std::size_t begin, end;
+    getShare(THREAD_ID, threadsNo, activated.size(), begin, end);
+    for (std::size_t index = begin; index < end; ++index) {
+      Superboid &super = superboids[activated[index]];
+      if (layer == BoxLayer::REAL) {
+        Box::locate(boxes, super);
+        for (const auto &mini : super.miniboids)
+          ++counts[mini.getBox().ID];
+      } else if (layer == BoxLayer::VIRTUAL)
+        for (auto &mini : super.virtualMiniboids()) {
+          const box_int boxID = Box::getBoxID(mini.position);
+          mini.setBox(&boxes[boxID]);
+          ++counts[boxID];
+        }
+      else
+        for (auto &segment : super.segments) {
+          setBoxes(segment);
+          forEachBox(segment, [&](const box_int boxID) { ++counts[boxID]; });
+        }
+    }
+  });
+
+  // Turn the counts of each box into offsets of each thread inside the box,
+  // keeping the box size in _end:
+  run([&](const thread_int THREAD_ID) {
+    std::size_t begin, end;
+    getShare(THREAD_ID, threadsNo, boxes.size(), begin, end);
+    for (std::size_t boxID = begin; boxID < end; ++boxID) {
+      std::size_t boxCount = 0u;
+      for (auto &counts : _counts) {
+        const std::size_t threadCount = counts[boxID];
+        counts[boxID]                 = boxCount;
+        boxCount += threadCount;
+      }
+      boxes[boxID]._end[l] = boxCount;
+    }
+  });
+
+  // Exclusive prefix sum over the boxes:
+  std::size_t offset = 0u;
+  for (auto &box : boxes) {
+    const std::size_t boxCount = box._end[l];
+    box._begin[l]              = offset;
+    box._end[l]                = offset + boxCount;
+    offset += boxCount;
   }
+  if (layer == BoxLayer::REAL)
+    _miniboids.resize(offset);
+  else if (layer == BoxLayer::VIRTUAL)
+    _virtuals.resize(offset);
+  else
+    _segments.resize(offset);
+
+  run([&](const thread_int THREAD_ID) {
+    std::vector<std::size_t> &counts = _counts[THREAD_ID];
+    auto scatter = [&](auto &layerMiniboids, const auto &superMiniboids) {
+      for (const auto &mini : superMiniboids) {
+        const Box &box = mini.getBox();
+        layerMiniboids[box._begin[l] + counts[box.ID]++] = &mini;
+      }
+    };
+
+    std::size_t begin, end;
+    getShare(THREAD_ID, threadsNo, activated.size(), begin, end);
+    for (std::size_t index = begin; index < end; ++index) {
+      const Superboid &super = superboids[activated[index]];
+      if (layer == BoxLayer::REAL)
+        scatter(_miniboids, super.miniboids);
+      else if (layer == BoxLayer::VIRTUAL)
+        scatter(_virtuals, super.virtualMiniboids());
+      else
+        for (const auto &segment : super.segments)
+          forEachBox(segment, [&](const box_int boxID) {
+            _segments[boxes[boxID]._begin[l] + counts[boxID]++] = &segment;
+          });
+    }
+  });
+
+  if (layer == BoxLayer::VIRTUAL)
+    _hasVirtuals = true;
+  else if (layer == BoxLayer::SEGMENT)
+    _hasSegments = true;
+
+  return;
+}
+
+void
+    Box::fill(ThreadPool &pool, std::vector<Box> &boxes,
+              std::vector<Superboid> &superboids) {
+  fill(pool.size(),
+       [&](const ThreadPool::Job &job) { pool.run("boxes", job); }, boxes,
+       superboids, BoxLayer::REAL);
+
+  return;
+}
+
+void
+    Box::fillVirtuals(ThreadPool &pool, std::vector<Box> &boxes,
+                      std::vector<Superboid> &superboids) {
+  fill(pool.size(),
+       [&](const ThreadPool::Job &job) { pool.run("virtualBoxes", job); },
+       boxes, superboids, BoxLayer::VIRTUAL);
+
+  return;
+}
+
+void
+    Box::fillSegments(ThreadPool &pool, std::vector<Box> &boxes,
+                      std::vector<Superboid> &superboids) {
+  fill(pool.size(),
+       [&](const ThreadPool::Job &job) { pool.run("segmentBoxes", job); },
+       boxes, superboids, BoxLayer::SEGMENT);
+
+  return;
+}
+
+void
+    Box::fill(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+              const bool contacts) {
+  const auto run = [](const ThreadPool::Job &job) { job(0u); };
+  fill(1u, run, boxes, superboids, BoxLayer::REAL);
+  if (!contacts)
+    clearVirtuals();
+  else if (parameters().CONTACT == Contact::VIRTUAL)
+    fill(1u, run, boxes, superboids, BoxLayer::VIRTUAL);
+  else
+    fill(1u, run, boxes, superboids, BoxLayer::SEGMENT);
 
   return;
 }
@@ -4,14 +4,17 @@
 
 #pragma once
 #include <cstdint>
-#include <list>
-#include <valarray>
 #include <vector>
 
+#include "Slice.hpp"
+#include "Vec.hpp"
 #include "parameters.hpp"
 
 class Miniboid;
 class Superboid;
+class ThreadPool;
+struct VirtualMiniboid;
+struct MembraneSegment;
 
 enum class CardinalPoint : uint16_t {
   ACTUAL,
@@ -25,6 +28,11 @@ enum class CardinalPoint : uint16_t {
   SOUTHWEST
 };
 
+/* Layers of the cell list. Virtual miniboids and membrane segments live for
+ * one step only and are kept apart from the real miniboids, so dropping them
+ * costs nothing. */
+enum class BoxLayer : uint16_t { REAL, VIRTUAL, SEGMENT, LAYERS_NO };
+
 class Box {
  public:
   Box(void);         /* Constructor. */
@@ -34,30 +42,88 @@ class Box {
   void setNeighbors(std::vector<Box> &boxes);
   std::vector<const Box *> neighbors;
 
-  std::list<const Miniboid *> miniboids;
-  /* Append a Superboid object to the list in this class. */
-  void append(Miniboid &mini);
-  /* Remove a Superboid object from the list in this class. */
-  inline void remove(const Miniboid &mini) {
-    this->miniboids.remove(&mini);
-    return;
+  /* Real miniboids in this box: a slice of the array shared by all boxes. */
+  inline const Miniboid *const *begin(void) const {
+    return this->slice(_miniboids, BoxLayer::REAL).begin();
+  }
+  inline const Miniboid *const *end(void) const {
+    return this->slice(_miniboids, BoxLayer::REAL).end();
+  }
+  inline std::size_t size(void) const {
+    return this->slice(_miniboids, BoxLayer::REAL).size();
+  }
+  /* Virtual miniboids in this box, if they were put in this step. */
+  inline Slice<const VirtualMiniboid *const> virtuals(void) const {
+    if (!_hasVirtuals)
+      return Slice<const VirtualMiniboid *const>(nullptr, nullptr);
+    return this->slice(_virtuals, BoxLayer::VIRTUAL);
+  }
+  /* Membrane segments touching this box, if they were put in this step. */
+  inline Slice<const MembraneSegment *const> segments(void) const {
+    if (!_hasSegments)
+      return Slice<const MembraneSegment *const>(nullptr, nullptr);
+    return this->slice(_segments, BoxLayer::SEGMENT);
   }
   /* Return density: cells per box. */
   inline real getDensity(void) const {
-    real raspberry = static_cast<real>(this->miniboids.size());
-    ;
+    real raspberry = static_cast<real>(this->size());
 
     return raspberry / parameters().MINIBOIDS_PER_SUPERBOID;
   }
+  /* Sort the real miniboids of the activated superboids into the boxes by
+   * counting sort on box ID, with per-thread histograms. */
+  static void fill(ThreadPool &pool, std::vector<Box> &boxes,
+                   std::vector<Superboid> &superboids);
+  /* Same for their virtual miniboids, in the virtual layer. */
+  static void fillVirtuals(ThreadPool &pool, std::vector<Box> &boxes,
+                           std::vector<Superboid> &superboids);
+  /* Same for their membrane segments, in the segment layer. */
+  static void fillSegments(ThreadPool &pool, std::vector<Box> &boxes,
+                           std::vector<Superboid> &superboids);
+  /* The real layer and, if contacts, the layer of the contact parameter, by
+   * the calling thread alone. */
+  static void fill(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+                   const bool contacts);
+  /* Empty the virtual and segment layers of every box. */
+  static inline void clearVirtuals(void) {
+    _hasVirtuals = false;
+    _hasSegments = false;
+  }
 
   static bool getIsInEdge(const box_int boxID);
-  static box_int getBoxID(const std::valarray<real> position);
+  static box_int getBoxID(const Vec2 &position);
+  /* Box of a real miniboid from its cached box coordinates. */
+  static box_int getBoxID(const std::size_t particleID);
   static inline void setNeighborBoxes(std::vector<Box> &boxes) {
     for (auto &box : boxes)
       box.setNeighbors(boxes);
   }
 
  private:
+  /* Set the box coordinates of all miniboids of a superboid in one pass. */
+  static void locate(std::vector<Box> &boxes, Superboid &superboid);
+  template<typename Run>
+  static void fill(const thread_int threadsNo, const Run &run,
+                   std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+                   const BoxLayer layer);
+  template<typename Mini>
+  inline Slice<const Mini *const> slice(const std::vector<const Mini *> &layer,
+                                        const BoxLayer l) const {
+    const uint16_t index = static_cast<uint16_t>(l);
+    return Slice<const Mini *const>(layer.data() + this->_begin[index],
+                                    layer.data() + this->_end[index]);
+  }
+
   static box_int _totalBoxesCount;
+  static std::vector<const Miniboid *> _miniboids;      /* Real layer. */
+  static std::vector<const VirtualMiniboid *> _virtuals; /* Virtual layer. */
+  static std::vector<const MembraneSegment *> _segments; /* Segment layer. */
+  static bool _hasVirtuals;
+  static bool _hasSegments;
+  /* [thread][box]: miniboids counted by the thread, then where the thread
+   * writes inside the box. */
+  static std::vector<std::vector<std::size_t>> _counts;
+  std::size_t _begin[static_cast<uint16_t>(BoxLayer::LAYERS_NO)];
+  std::size_t _end[static_cast<uint16_t>(BoxLayer::LAYERS_NO)];
   Box(const Box &) = delete; /* Invalidate use of copy constructor. */
 };
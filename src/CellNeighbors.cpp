@@ -4,20 +4,45 @@
 
 #include "CellNeighbors.hpp"
 
-const std::list<super_int>&
-    CellNeighbors::operator()(void) {
-  if (this->_duplicates) {
-    this->_list.unique();
-    this->_list.sort();
-    this->_list.unique();
-    this->_duplicates = false;
+#include <algorithm>
+
+void
+    CellNeighbors::insert(const super_int id) {
+  const super_int *position = std::lower_bound(this->begin(), this->end(), id);
+  if (position != this->end() && *position == id)
+    return;
+  const super_int index = position - this->begin();
+
+  if (!this->_onHeap && this->_size == INLINE_NO) {
+    this->_heap.assign(this->_inline, this->_inline + INLINE_NO);
+    this->_onHeap = true;
+  }
+
+  if (this->_onHeap)
+    this->_heap.insert(this->_heap.begin() + index, id);
+  else {
+    std::copy_backward(this->_inline + index, this->_inline + this->_size,
+                       this->_inline + this->_size + 1u);
+    this->_inline[index] = id;
   }
-  return this->_list;
+  ++this->_size;
+
+  return;
 }
 
 void
-    CellNeighbors::append(const super_int id) {
-  this->_list.push_back(id);
-  this->_duplicates = true;
+    CellNeighbors::remove(const super_int id) {
+  const super_int *position = std::lower_bound(this->begin(), this->end(), id);
+  if (position == this->end() || *position != id)
+    return;
+  const super_int index = position - this->begin();
+
+  if (this->_onHeap)
+    this->_heap.erase(this->_heap.begin() + index);
+  else
+    std::copy(this->_inline + index + 1u, this->_inline + this->_size,
+              this->_inline + index);
+  --this->_size;
+
   return;
 }
@@ -3,22 +3,40 @@
 // License specified in LICENSE file.
 
 #pragma once
-#include <list>
+#include <vector>
 
-#include "Miniboid.hpp"
 #include "parameters.hpp"
 
+// Sorted IDs of the superboids neighboring a superboid, each once. Only the
+// thread owning the superboid in a phase writes to it (see
+// PairSearch::scatter). The first INLINE_NO IDs are kept inline; more move
+// to the heap, whose capacity clear keeps.
 class CellNeighbors {
  public:
-  const std::list<super_int> &operator()(void);
-  void append(const super_int id);
-  inline CellNeighbors(void) : _duplicates(true) { return; }
-  inline void remove(const super_int id) {
-    this->_list.remove(id);
+  static const super_int INLINE_NO = 16u;
+  inline CellNeighbors(void) : _size(0u), _onHeap(false) { return; }
+  void insert(const super_int id);
+  void remove(const super_int id);
+  inline void clear(void) {
+    this->_size   = 0u;
+    this->_onHeap = false;
+    this->_heap.clear();
     return;
   }
+  inline super_int size(void) const { return this->_size; }
+  inline const super_int *begin(void) const {
+    return this->_onHeap ? this->_heap.data() : this->_inline;
+  }
+  inline const super_int *end(void) const {
+    return this->begin() + this->_size;
+  }
+  inline super_int operator[](const super_int n) const {
+    return this->begin()[n];
+  }
 
  protected:
-  bool _duplicates;
-  std::list<super_int> _list;
+  super_int _size;
+  bool _onHeap;
+  super_int _inline[INLINE_NO];
+  std::vector<super_int> _heap;  // All the IDs, once on the heap.
 };
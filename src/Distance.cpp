@@ -5,23 +5,15 @@
 #include "Distance.hpp"
 
 #include <cmath>
-#include <stdexcept>
 
 #include "Miniboid.hpp"
 #include "Superboid.hpp"
 #include "parameters.hpp"
 
-Distance::Distance(const std::valarray<real> &va)
-    : miniboid1(nullptr), miniboid2(nullptr) {
-  if (va.size() != 2)
-    throw std::length_error("Only 2D supported.");
-
-  this->module = -0.0;
-  for (auto &comp : va)
-    this->module += square(comp);
-  this->module = std::sqrt(this->module);
-  this->cosine = va[X] / this->module;
-  this->sine   = va[Y] / this->module;
+Distance::Distance(const Vec2 &v) : miniboid1(nullptr), miniboid2(nullptr) {
+  this->module = std::sqrt(square(v[X]) + square(v[Y]));
+  this->cosine = v[X] / this->module;
+  this->sine   = v[Y] / this->module;
 }
 
 Distance::Distance(const Miniboid &m1, const Miniboid &m2)
@@ -30,49 +22,45 @@ Distance::Distance(const Miniboid &m1, const Miniboid &m2)
     , module(-0.0f)
     , sine(-0.0f)
     , cosine(-0.0f) {
-  const Distance d = Distance(m1.position, m2.position);
-  this->module     = d.module;
-  this->sine       = d.sine;
-  this->cosine     = d.cosine;
+  this->set(m2.position[X] - m1.position[X], m2.position[Y] - m1.position[Y]);
 
   return;
 }
 
-Distance::Distance(const std::valarray<real> &position1,
-                   const std::valarray<real> &position2)
-    : miniboid1(nullptr)
+Distance::Distance(const Miniboid &m1, const VirtualMiniboid &m2)
+    : miniboid1(&m1)
     , miniboid2(nullptr)
     , module(-0.0f)
     , sine(-0.0f)
     , cosine(-0.0f) {
-  std::valarray<real> delta(position2 - position1);
-  // if (std::fabs(position1[X]) < 1.0e-6f || std::fabs(position2[X]) < 1.0e-6f
-  // || std::fabs(position1[Y]) < 1.0e-6f || std::fabs(position2[Y]) < 1.0e-6f)
-  //   std::cerr << "Distance::Distance: delta = " << delta << std::endl;
-
-  const real HALF_RANGE = parameters().RANGE / 2.0f;
-  real sumOfSquares     = -0.0f;
-  for (real &component : delta) {
-    if (std::fabs(component) >= HALF_RANGE)
-      component -= sign(component) * parameters().RANGE;
-    sumOfSquares += square(component);
-  }
+  this->set(m2.position[X] - m1.position[X], m2.position[Y] - m1.position[Y]);
+
+  return;
+}
 
-  this->module = std::sqrt(sumOfSquares);
+void
+    Distance::set(real deltaX, real deltaY) {
+  deltaX = getMinimalImage(deltaX);
+  deltaY = getMinimalImage(deltaY);
+
+  this->module = std::sqrt(square(deltaX) + square(deltaY));
   if (this->module > 1.0e-6) {
-    this->cosine = delta[X] / this->module;
-    this->sine   = delta[Y] / this->module;
+    this->cosine = deltaX / this->module;
+    this->sine   = deltaY / this->module;
   }
 
   return;
 }
 
-std::valarray<real>
-    Distance::getDirectionArray(void) const {
-  std::valarray<real> va(parameters().DIMENSIONS);
-  va[X] = this->cosine;
-  va[Y] = this->sine;
-  return va;
+Distance::Distance(const Vec2 &position1, const Vec2 &position2)
+    : miniboid1(nullptr)
+    , miniboid2(nullptr)
+    , module(-0.0f)
+    , sine(-0.0f)
+    , cosine(-0.0f) {
+  this->set(position2[X] - position1[X], position2[Y] - position1[Y]);
+
+  return;
 }
 
 real
@@ -85,13 +73,6 @@ real
   return angle;
 }
 
-std::valarray<real>
-    Distance::getTangentArray(void) const {
-  real newAngle         = this->getAngle() + HALF_PI;
-  std::valarray<real> a = {std::cos(newAngle), std::sin(newAngle)};
-  return a;
-}
-
 real
     assertAngle(real anglie) {
   while (anglie < -PI)
@@ -5,11 +5,11 @@
 #pragma once
 
 #include <iostream>
-#include <valarray>
-
+#include "Vec.hpp"
 #include "parameters.hpp"
 
 class Miniboid;
+struct VirtualMiniboid;
 
 class Distance {
  public:
@@ -20,6 +20,7 @@ class Distance {
   real cosine;
 
   Distance(const Miniboid &miniA, const Miniboid &miniB);
+  Distance(const Miniboid &miniA, const VirtualMiniboid &miniB);
   inline Distance(void)
       : miniboid1(nullptr), miniboid2(nullptr), module(0), sine(0), cosine(0) {
     return;
@@ -32,12 +33,27 @@ class Distance {
       , cosine(d.cosine) {
     return;
   }
-  Distance(const std::valarray<real> &);
-  Distance(const std::valarray<real> &, const std::valarray<real> &D);
+  Distance &operator=(const Distance &) = default;
+  Distance(const Vec2 &);
+  Distance(const Vec2 &, const Vec2 &D);
   // inline bool operator()() const { return this->module != 0.0f; }
-  std::valarray<real> getDirectionArray(void) const;
+  // Minimal image of a 2D delta, from the first to the second position.
+  void set(real deltaX, real deltaY);
+  // Minimal image of one component of a delta.
+  static inline real getMinimalImage(const real delta) {
+    const real HALF_RANGE = parameters().RANGE / 2.0f;
+    if (std::fabs(delta) >= HALF_RANGE)
+      return delta - sign(delta) * parameters().RANGE;
+    return delta;
+  }
+  inline Vec2 getDirectionArray(void) const {
+    return Vec2(this->cosine, this->sine);
+  }
   real getAngle(void) const;
-  std::valarray<real> getTangentArray(void) const;
+  // Direction turned a quarter of a turn counterclockwise.
+  inline Vec2 getTangentArray(void) const {
+    return Vec2(-this->sine, this->cosine);
+  }
 };
 
 inline std::ostream &
@@ -108,6 +124,19 @@ inline bool
 
 extern real
     angleBetween(const real phi1, const real phi2);
+// Same as angleBetween of the angles of the directions (cosine1, sine1) and
+// (cosine2, sine2), from their cross and dot products.
+inline real
+    angleBetween(const real cosine1, const real sine1, const real cosine2,
+                 const real sine2) {
+  return std::atan2(cosine1 * sine2 - sine1 * cosine2,
+                    cosine1 * cosine2 + sine1 * sine2);
+}
+// Same as sin(|angleBetween(d1, d2)|).
+inline real
+    sineBetween(const Distance &d1, const Distance &d2) {
+  return std::fabs(d1.cosine * d2.sine - d1.sine * d2.cosine);
+}
 extern real
     assertAngle(real anglie);
 
@@ -15,46 +15,35 @@
 #include "Superboid.hpp"
 #include "elastic_plastic.hpp"
 #include "export.hpp"
-#include "lines.hpp"
 
 std::ostream &
     operator<<(std::ostream &os, const Miniboid &mini) {
   const real diameter = (mini.ID == 0u) ? 4.0f * parameters().PRINT_CORE
                                         : parameters().PRINT_CORE;
   os << mini.position << diameter << '\t'
-     << mini.superboid.cellNeighbors().size();
+     << mini.superboid.cellNeighbors.size();
   return os;
 }
 
-std::valarray<real>
+std::size_t
+    Miniboid::getParticleID(const Superboid &super, const mini_int id) {
+  return static_cast<std::size_t>(super.ID) * parameters().MINIBOIDS_PER_SUPERBOID
+         + id;
+}
+
+VecN<1u>
     Miniboid::getAngles(const mini_int id) {
   static const real DELTA_ANGLE
       = (TWO_PI / (parameters().MINIBOIDS_PER_SUPERBOID - 1u));
-  std::valarray<real> angles(parameters().DIMENSIONS - 1u);
+  VecN<1u> angles;
   if (id != 0u)
     angles[0u] = DELTA_ANGLE * (id - 1u);
   return angles;
 }
 
-void
-    Miniboid::checkLimits(const step_int step) {
-  if (step != 0)
-    this->checkKillCondition(step);
-
-  if (parameters().BC == BoundaryCondition::PERIODIC)
-    this->checkPeriodicLimits();
-  else if (parameters().BC == BoundaryCondition::RECTANGLE
-           || parameters().BC == BoundaryCondition::STOKES)
-    this->checkRectangularLimits();
-
-  if (parameters().BC == BoundaryCondition::STOKES && this->isVirtual == false)
-    this->checkStokesLimits();
-
-  return;
-}
-
+template<typename Array>
 static void
-    checkPeriodicLimits(std::valarray<real> &position) {
+    checkPeriodicLimits(Array &position) {
   static const real HALF_RANGE(parameters().RANGE / 2.0f);
 
   for (auto &component : position) {
@@ -67,31 +56,26 @@ static void
   return;
 }
 
-void
-    Miniboid::checkPeriodicLimits() {
-  ::checkPeriodicLimits(this->position);
-
-  return;
-}
-
-void
-    Miniboid::checkKillCondition(const step_int step) {
-  if (this->superboid.isActivated() == false || this->superboid.willDie())
+// Kill condition of a superboid with some miniboid at x.
+static void
+    checkKillCondition(Superboid &superboid, const real x,
+                       const step_int step) {
+  if (superboid.isActivated() == false || superboid.willDie())
     return;
 
   if (parameters().KILL_CONDITION == KillCondition::RIGHT_EDGE
       || parameters().KILL_CONDITION == KillCondition::RIGHT_EDGE_OR_P0)
-    if (this->position[X] >= parameters().RECTANGLE_SIZE[X] / 2.0f) {
-      this->superboid.setDeactivation("right egde");
+    if (x >= parameters().RECTANGLE_SIZE[X] / 2.0f) {
+      superboid.setDeactivation("right egde");
       return;
     }
 
   if (parameters().KILL_CONDITION == KillCondition::P0
       || parameters().KILL_CONDITION == KillCondition::RIGHT_EDGE_OR_P0) {
-    this->superboid.setShape(step);
-    const real P0 = this->superboid.perimeter / std::sqrt(this->superboid.area);
+    superboid.setShape(step);
+    const real P0 = superboid.perimeter / std::sqrt(superboid.area);
     if (P0 > parameters().P0_LIMIT) {
-      this->superboid.setDeactivation("P0");
+      superboid.setDeactivation("P0");
       return;
     }
   }
@@ -99,48 +83,110 @@ void
   return;
 }
 
-void
-    Miniboid::checkRectangularLimits() {
+// Bring a position back inside the rectangle, telling for each dimension
+// whether it was reflected on a wall.
+template<typename Array>
+static void
+    checkRectangularLimits(Array &position, const type_int type,
+                           bool reflected[]) {
   static const real THREE_HALFS_RANGE(1.5f * parameters().RANGE);
 
-  for (auto &component : this->position) {
+  for (auto &component : position) {
     while (component <= -THREE_HALFS_RANGE)
       component += parameters().RANGE;
     while (component > THREE_HALFS_RANGE)
       component -= parameters().RANGE;
   }
-  for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim) {
+  for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim) {
     const real HALF_RECTANGLE_SIZE = 0.5f * parameters().RECTANGLE_SIZE[dim];
-    if (this->position[dim] < -HALF_RECTANGLE_SIZE) {
-      real delta = this->position[dim] + HALF_RECTANGLE_SIZE;
-      if (-2.0f * delta
-          < parameters().DT * parameters().SPEED[this->superboid.type])
-        this->position[dim] -= 2.0f * delta;
+    reflected[dim]                 = true;
+    if (position[dim] < -HALF_RECTANGLE_SIZE) {
+      real delta = position[dim] + HALF_RECTANGLE_SIZE;
+      if (-2.0f * delta < parameters().DT * parameters().SPEED[type])
+        position[dim] -= 2.0f * delta;
       else
-        this->position[dim]
-            = -HALF_RECTANGLE_SIZE + parameters().REAL_TOLERANCE;
-      this->velocity[dim] *= -1.0f;
-      this->newVelocity[dim] *= -1.0f;
-    } else if (this->position[dim] > HALF_RECTANGLE_SIZE) {
-      real delta = this->position[dim] - HALF_RECTANGLE_SIZE;
-      if (2.0f * delta
-          < parameters().DT * parameters().SPEED[this->superboid.type])
-        this->position[dim] -= 2.0f * delta;
+        position[dim] = -HALF_RECTANGLE_SIZE + parameters().REAL_TOLERANCE;
+    } else if (position[dim] > HALF_RECTANGLE_SIZE) {
+      real delta = position[dim] - HALF_RECTANGLE_SIZE;
+      if (2.0f * delta < parameters().DT * parameters().SPEED[type])
+        position[dim] -= 2.0f * delta;
       else
-        this->position[dim] = HALF_RECTANGLE_SIZE - parameters().REAL_TOLERANCE;
+        position[dim] = HALF_RECTANGLE_SIZE - parameters().REAL_TOLERANCE;
+    } else
+      reflected[dim] = false;
+  }
+
+  return;
+}
+
+void
+    Miniboid::checkLimits(const step_int step) {
+  if (step != 0)
+    this->checkKillCondition(step);
+
+  if (parameters().BC == BoundaryCondition::PERIODIC)
+    this->checkPeriodicLimits();
+  else if (parameters().BC == BoundaryCondition::RECTANGLE
+           || parameters().BC == BoundaryCondition::STOKES)
+    this->checkRectangularLimits();
+
+  if (parameters().BC == BoundaryCondition::STOKES)
+    this->checkStokesLimits();
+
+  return;
+}
+
+// Virtual miniboids are not kept out of the Stokes holes and have no velocity
+// to reflect.
+void
+    VirtualMiniboid::checkLimits(const step_int step) {
+  if (step != 0)
+    ::checkKillCondition(*this->superboid, this->position[X], step);
+
+  if (parameters().BC == BoundaryCondition::PERIODIC)
+    ::checkPeriodicLimits(this->position);
+  else if (parameters().BC == BoundaryCondition::RECTANGLE
+           || parameters().BC == BoundaryCondition::STOKES) {
+    bool reflected[Vec2::DIMENSIONS];
+    ::checkRectangularLimits(this->position, this->superboid->type, reflected);
+  }
+
+  return;
+}
+
+void
+    Miniboid::checkPeriodicLimits() {
+  ::checkPeriodicLimits(this->position);
+
+  return;
+}
+
+void
+    Miniboid::checkKillCondition(const step_int step) {
+  ::checkKillCondition(this->superboid, this->position[X], step);
+
+  return;
+}
+
+void
+    Miniboid::checkRectangularLimits() {
+  bool reflected[Vec2::DIMENSIONS];
+  ::checkRectangularLimits(this->position, this->superboid.type, reflected);
+  for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim)
+    if (reflected[dim]) {
       this->velocity[dim] *= -1.0f;
       this->newVelocity[dim] *= -1.0f;
     }
-  }
+
   return;
 }
 
 void
     Miniboid::checkStokesLimits() {
+  const box_int myBoxID = Box::getBoxID(this->position);
   for (const auto &hole : parameters().STOKES_HOLES) {
     if (this->_box) {
-      bool skip             = true;
-      const box_int myBoxID = Box::getBoxID(this->position);
+      bool skip = true;
       for (const auto boxID_2 : hole.boxIDs) {
         if (boxID_2 == myBoxID) {
           skip = false;
@@ -153,15 +199,15 @@ void
     }
 
     const real TOLERABLE
-        = (this->ID == 0u && !this->isVirtual)
+        = (this->ID == 0u)
               ? (hole.radius
                  + parameters().RADIAL_REQ[this->superboid.type] / 2.0f)
               : hole.radius;
     const Distance d(hole.center, this->position);
 
     if (d.module < TOLERABLE) {
-      std::valarray<real> direction = d.getDirectionArray();
-      real delta                    = d.module - TOLERABLE;
+      const Vec2 direction = d.getDirectionArray();
+      real delta           = d.module - TOLERABLE;
       if (2.0f * delta
           < parameters().DT * parameters().SPEED[this->superboid.type])
         this->position -= direction * (2.0f * delta);
@@ -175,23 +221,14 @@ void
 
 void
     Miniboid::checkFatOut(void) {
-  if (this->ID != 0 || this->isVirtual)
+  if (this->ID != 0)
     return;
 
-  bool isFatOut = true;
-  for (mini_int miniID = 2; miniID < parameters().MINIBOIDS_PER_SUPERBOID - 1;
-       ++miniID)
-    if (isPointInTriangle(this->position,
-                          this->superboid.miniboids[1u].position,
-                          this->superboid.miniboids[miniID].position,
-                          this->superboid.miniboids[miniID + 1].position)) {
-      isFatOut = false;
-      break;
-    }
+  const bool isFatOut = !this->superboid.isNucleusInside();
 
   if (isFatOut) {
     this->superboid.setDeactivation("umbrella");
-    // std::valarray<real> cm(-0.0f, parameters().DIMENSIONS);
+    // Vec2 cm(-0.0f);
     // for (const auto& mini : this->superboid.miniboids)
     //   if (mini.ID > 1)
     //   {
@@ -207,119 +244,32 @@ void
   return;
 }
 
-void
-    Miniboid::noise(void) {
-  real angle      = this->superboid.get0to2piRandom();
-  this->_noiseSum = std::valarray<real>({std::cos(angle), std::sin(angle)});
-  this->_noiseSum *= parameters().ETA;
-
-  return;
-}
-
-bool
-    isPointInTriangle(const std::valarray<real> &p_test,
-                      const std::valarray<real> &p0,
-                      const std::valarray<real> &p1,
-                      const std::valarray<real> &p2) {
-  const Distance d(p_test, p0);
-  const real dX = d.module * d.cosine;
-  const real dY = d.module * d.sine;
-
-  const Distance d20(p2, p0);
-  const real dX20 = d20.module * d20.cosine;
-  const real dY20 = d20.module * d20.sine;
-
-  const Distance d10(p1, p0);
-  const real dX10 = d10.module * d10.cosine;
-  const real dY10 = d10.module * d10.sine;
-
-  const real s_p = (dY20 * dX) - (dX20 * dY);
-  const real t_p = (dX10 * dY) - (dY10 * dX);
-  const real D   = (dX10 * dY20) - (dY10 * dX20);
-
-  if (D > 0.0f)
-    return ((s_p >= 0.0f) && (t_p >= 0.0f) && (s_p + t_p) <= D);
-  else
-    return ((s_p <= 0.0f) && (t_p <= 0.0f) && (s_p + t_p) >= D);
-}
-
-bool
-    isPointInSomeNthTriangle(const mini_int nth,
-                             const std::valarray<real> &point,
-                             const Superboid &super) {
-  const Miniboid &fatboid = super.miniboids[0u];
-  bool inSomeTriangle     = false;
-  const Miniboid *auxMini = &super.miniboids.back();
-
-  for (auto &realMini : super.miniboids) {
-    if (realMini.ID == 0)
-      continue;
-    if (inSomeTriangle)
-      break;
-    mini_int nextID
-        = realMini.ID % (parameters().MINIBOIDS_PER_SUPERBOID - 1) + nth;
-    nextID %= parameters().MINIBOIDS_PER_SUPERBOID - 1;
-    auxMini        = &super.miniboids[nextID];
-    inSomeTriangle = isPointInTriangle(point, fatboid.position,
-                                       auxMini->position, realMini.position);
-  }
-
-  return inSomeTriangle;
-}
-
-bool
-    Miniboid::isInSomeNthTriangle(const mini_int nth, const Superboid &super) {
-  const Miniboid &fatboid = super.miniboids[0u];
-  bool inSomeTriangle     = false;
-  const Miniboid *auxMini = &super.miniboids.back();
-
-  for (auto &realMini : super.miniboids) {
-    if (realMini.ID == 0)
-      continue;
-    if (inSomeTriangle)
-      break;
-    mini_int nextID
-        = realMini.ID % (parameters().MINIBOIDS_PER_SUPERBOID - 1) + nth;
-    nextID %= parameters().MINIBOIDS_PER_SUPERBOID - 1;
-    auxMini        = &super.miniboids[nextID];
-    inSomeTriangle = isPointInTriangle(this->position, fatboid.position,
-                                       auxMini->position, realMini.position);
-  }
-
-  return inSomeTriangle;
-}
-
 bool
     Miniboid::fatInteractions(const step_int STEP,
-                              const std::list<Neighbor> &list,
+                              const NeighborCell &cell,
                               const bool interact) {
   bool inSomeTriangle = false;
 
-  if (list.empty())
+  if (cell.empty())
     return inSomeTriangle;
 
-  const Superboid &super  = list.front().miniNeighbor.superboid;
-  const Miniboid &fatboid = super.miniboids[0u];
+  const Superboid &super = *cell.front().superboid;
 
-  if (super.ID != this->superboid.ID) {
+  // The fan is inside the bounding circle.
+  if (super.ID != this->superboid.ID
+      && this->superboid.mayReach(super, Vec2(this->position), 0.0f)) {
     for (mini_int nth = 1; nth <= 2; ++nth) {
-      std::valarray<real> tangent(parameters().DIMENSIONS);
-
-      const Miniboid *auxMini = nullptr;
-      for (auto &realMini : super.miniboids) {
-        if (realMini.ID == 0)
-          continue;
-        if (inSomeTriangle)
-          break;
-        mini_int nextID
-            = realMini.ID % (parameters().MINIBOIDS_PER_SUPERBOID - 1) + nth;
-        nextID %= parameters().MINIBOIDS_PER_SUPERBOID - 1;
-        auxMini = &super.miniboids[nextID];
-
-        inSomeTriangle
-            = isPointInTriangle(this->position, fatboid.position,
-                                realMini.position, auxMini->position);
-        if (inSomeTriangle && interact) {
+      Vec2 tangent;
+
+      // Only the first triangle found counts.
+      const TriangleFan &fan = super.nucleusFan(nth);
+      const std::size_t triangle
+          = inSomeTriangle ? fan.size() : fan.find(Vec2(this->position));
+      if (triangle < fan.size()) {
+        inSomeTriangle = true;
+        if (interact) {
+          const Miniboid &realMini = super.miniboids[fan.firstID(triangle)];
+          const Miniboid &auxMini  = super.miniboids[fan.secondID(triangle)];
           std::tuple<step_int, std::vector<const Miniboid *>> *h = nullptr;
           for (auto &c : this->history)
             if (std::get<1>(c).front()->superboid.ID == super.ID) {
@@ -333,36 +283,29 @@ bool
           } else {
             this->history.push_back(
                 std::tuple<step_int, std::vector<const Miniboid *>>(
-                    STEP, std::vector<const Miniboid *>({auxMini, &realMini})));
-            tangent = Distance(realMini, *auxMini).getTangentArray();
+                    STEP, std::vector<const Miniboid *>({&auxMini, &realMini})));
+            tangent = Distance(realMini, auxMini).getTangentArray();
           }
         }
       }
-      auxMini = nullptr;
 
       if (inSomeTriangle)
         this->_lastInvasionStep = STEP;
 
       if (inSomeTriangle && interact) {
-        //// const std::valarray<real> tangent = tangentSignal * Distance(r1,
-        /// r2).getTangentArray(); / const std::valarray<real> tangent =
+        //// const Vec2 tangent = tangentSignal * Distance(r1,
+        /// r2).getTangentArray(); / const Vec2 tangent =
         /// Distance(fatboid.position, r0 - tangent).module >
         /// Distance(fatboid.position, r0 + tangent).module ? -tangent :
         /// tangent;
-        const std::valarray<real> force1
-            = (0.9f * parameters().INFINITE_FORCE) * tangent;
-        const std::valarray<real> radial
-            = this->radialDistance.getDirectionArray();
-        const std::valarray<real> force2
-            = radial * (0.9f * parameters().INFINITE_FORCE);
+        const Vec2 force1 = (0.9f * parameters().INFINITE_FORCE) * tangent;
+        const Vec2 radial = this->radialDistance.getDirectionArray();
+        const Vec2 force2 = radial * (0.9f * parameters().INFINITE_FORCE);
         if (Infinite::write()) {
-          std::valarray<real> direction = tangent + radial;
+          Vec2 direction = tangent + radial;
           direction /= getModule(direction);
-          std::valarray<real> infThing(parameters().DIMENSIONS * 2u);
-          for (std::size_t i = 0; i < parameters().DIMENSIONS; ++i)
-            infThing[i] = this->position[i];
-          for (std::size_t i = 0; i < parameters().DIMENSIONS; ++i)
-            infThing[i + parameters().DIMENSIONS] = direction[i];
+          const VecN<4u> infThing(this->position[X], this->position[Y],
+                                  direction[X], direction[Y]);
           this->superboid.infinite2Vectors.push_back(infThing);
         }
 
@@ -377,34 +320,33 @@ bool
 
 void
     Miniboid::interInteractions(const Neighbor &neighbor) {
-  const Miniboid &miniNeighbor = neighbor.miniNeighbor;
-  if (this->ID == 0 || miniNeighbor.ID == 0)
+  if (this->ID == 0 || neighbor.ID == 0)
     return;
-  if (this->superboid.ID != miniNeighbor.superboid.ID) {
-    const type_int MY_TYPE       = this->superboid.type;
-    const type_int NEIGHBOR_TYPE = miniNeighbor.superboid.type;
+  if (this->superboid.ID != neighbor.superboid->ID) {
+    const type_int MY_TYPE = this->superboid.type;
+    const TypePair &pair
+        = parameters().getTypePair(MY_TYPE, neighbor.superboid->type);
 
-    // Sum velocity (ALPHA):
-    this->_velocitySum += miniNeighbor.velocity
-                          * parameters().INTER_ALPHA[MY_TYPE][NEIGHBOR_TYPE];
+    // Sum velocity (ALPHA), virtual miniboids have none:
+    if (neighbor.miniNeighbor != nullptr)
+      this->_velocitySum += neighbor.miniNeighbor->velocity * pair.interAlpha;
 
     // Sum force (BETA):
-    const real beta = parameters().INTER_BETA[MY_TYPE][NEIGHBOR_TYPE];
-    const real rEq  = parameters().INTER_REQ[MY_TYPE][NEIGHBOR_TYPE];
+    const real beta = pair.interBeta;
+    const real rEq  = pair.interReq;
     if (neighbor.distance.module <= parameters().CORE_DIAMETER) {
-      const std::valarray<real> d = neighbor.distance.getDirectionArray();
+      const Vec2 d = neighbor.distance.getDirectionArray();
       this->_forceSum += -parameters().INFINITE_FORCE * d;
 
       if (Infinite::write()) {
-        std::valarray<real> infThing(parameters().DIMENSIONS * 2u);
-        for (std::size_t i = 0; i < parameters().DIMENSIONS; ++i)
-          infThing[i] = this->position[i];
-        for (std::size_t i = 0; i < parameters().DIMENSIONS; ++i)
-          infThing[i + parameters().DIMENSIONS] = -d[i];
+        const VecN<4u> infThing(this->position[X], this->position[Y], -d[X],
+                                -d[Y]);
         this->superboid.infiniteVectors.push_back(infThing);
       }
     } else {
-      std::valarray<real> force = -getFiniteForce(neighbor.distance, beta, rEq);
+      const Vec2 force
+          = -getFiniteForce(pair.interLaw, neighbor.distance.module, beta, rEq)
+            * neighbor.distance.getDirectionArray();
       this->_forceSum += force;
     }
   }
@@ -420,92 +362,85 @@ void
       break;
     }
 
-  for (const auto &pair : this->_neighbors) {
-    const auto &list = std::get<1>(pair);
-    // Interaction with peripheral miniboids:
-    if (true) {
-      if (list.size() == 1)
-        this->interInteractions(list.front());
-      else if (list.size() > 1) {
-        super_int count            = 0;
-        const Miniboid *firstMini  = nullptr;
-        const Miniboid *secondMini = nullptr;
-
-        for (const auto &particleNei : list) {
-          if (count == 0)
-            firstMini = &particleNei.miniNeighbor;
-          else if (count == 1)
-            secondMini = &particleNei.miniNeighbor;
-          else
-            break;
-
-          ++count;
-        }
-
-        Miniboid mini(0, firstMini->superboid, true);
-        mini.velocity = firstMini->velocity;
-        const real angularCoeff
-            = getAngularCoefficient(firstMini->position, secondMini->position);
-        mini.position = getClosestPoint(angularCoeff, firstMini->position,
-                                        this->position);
-        const Distance dist(*this, mini);
-        const Neighbor miniN(mini, dist);
-        this->interInteractions(miniN);
-      }
-    } else
-      for (const auto &particleNei : list)
-        this->interInteractions(particleNei);
+  for (const auto &cell : this->_neighbors) {
+    // Interaction with peripheral miniboids. The closest point of a cell
+    // with two or more neighbors was passed as its miniboid 0, which is
+    // skipped, so only cells with a single neighbor interact.
+    if (cell.size == 1)
+      this->interInteractions(cell.front());
 
     // Check if interacts with fatboid:
-    this->fatInteractions(STEP, list, true);
+    this->fatInteractions(STEP, cell, true);
 
-  }  // end of for pair in _neighbors.
+  }  // end of for cell in _neighbors.
 
   return;
 }
 
 real
-    Miniboid::getHarrisParameter(const std::vector<std::vector<real>> &matrix,
-                                 const std::vector<real> &medium) const {
-  const type_int MY_TYPE = this->superboid.type;
-  const mini_int TOTAL   = parameters().HARRIS_AMOUNT[this->superboid.type];
-  mini_int total         = 0;
-  std::vector<mini_int> counts(parameters().TYPES_NO, 0);
-
-  for (const auto &pair : this->_neighbors) {
-    const auto &superList = std::get<1>(pair);
-    for (const auto &neighbor : superList) {
-      ++counts[neighbor.miniNeighbor.superboid.type];
-      ++total;
-    }
+    Miniboid::getHarrisParameter(real sum, const real medium,
+                                 const mini_int total) const {
+  const mini_int TOTAL = parameters().HARRIS_AMOUNT[this->superboid.type];
+
+  if (total >= TOTAL)
+    sum /= total;
+  else {
+    sum += (TOTAL - total) * medium;
+    sum /= TOTAL;
   }
 
-  real harris = -0.0f;
+  return sum;
+}
 
-  for (type_int t = 0u; t < parameters().TYPES_NO; ++t) {
-    harris += matrix[MY_TYPE][t] * counts[t];
+// Sums of the Harris weights of the neighbors, by type, into sums: radial
+// beta, kapa and tangent beta.
+template<type_int TYPES_NO>
+static void
+    sumHarrisWeights(const TypePair *pairs, const mini_int *counts,
+                     real *sums) {
+  const type_int typesNo = TYPES_NO != 0u ? TYPES_NO : parameters().TYPES_NO;
+  for (type_int t = 0u; t < typesNo; ++t) {
+    sums[0u] += pairs[t].radialBeta * counts[t];
+    sums[1u] += pairs[t].kapa * counts[t];
+    sums[2u] += pairs[t].tangentBeta * counts[t];
   }
 
-  if (total >= TOTAL)
-    harris /= total;
-  else {
-    harris += (TOTAL - total) * medium[MY_TYPE];
-    harris /= TOTAL;
+  return;
+}
+
+void
+    Miniboid::setHarrisParameters(void) {
+  this->_neighborsPerTypeNos = 0u;
+  mini_int total             = 0;
+  for (const auto &cell : this->_neighbors) {
+    if (cell.empty())
+      continue;
+    this->_neighborsPerTypeNos[cell.front().superboid->type] += cell.count;
+    total += cell.count;
   }
 
-  return harris;
+  const type_int MY_TYPE = this->superboid.type;
+  real sums[3u]          = {-0.0f, -0.0f, -0.0f};
+  TYPES_KERNEL(sumHarrisWeights, parameters().getTypePairs(MY_TYPE),
+               &this->_neighborsPerTypeNos[0u], sums);
+
+  this->_radialBeta = this->getHarrisParameter(
+      sums[0u], parameters().RADIAL_BETA_MEDIUM[MY_TYPE], total);
+  this->_kapa = this->getHarrisParameter(
+      sums[1u], parameters().KAPA_MEDIUM[MY_TYPE], total);
+  this->_tangentBeta = this->getHarrisParameter(
+      sums[2u], parameters().TANGENT_BETA_MEDIUM[MY_TYPE], total);
+
+  return;
 }
 
 void
     Miniboid::setNextVelocity(const step_int STEP) {
-  if (this->isVirtual)
-    return;
-
-  this->noise();  // Find a random noise (ETA).
+  // Superboid::setNoises set the noise (ETA).
   const type_int MY_TYPE = this->superboid.type;
 
   // Interact with miniboids of another superboid:
-  if (this->ID != 0 && !this->isVirtual)
+  if (this->ID != 0)
     this->interInteractions(STEP);
 
   // Same superboid:
@@ -513,111 +448,8 @@ void
   for (const auto &mini : miniboidsInThisCell)
     this->_velocitySum += parameters().AUTO_ALPHA[MY_TYPE] * mini.velocity;
 
-  // Radial:
-  if (this->ID == 0u) {
-    for (auto &mini : miniboidsInThisCell)
-      if (mini.ID != 0u) {
-        if (mini.radialDistance.module <= parameters().CORE_DIAMETER)
-          this->_forceSum += parameters().INFINITE_FORCE
-                             * mini.radialDistance.getDirectionArray();
-        else {
-          const real beta = mini.getHarrisParameter(
-              parameters().RADIAL_BETA, parameters().RADIAL_BETA_MEDIUM);
-          const real req = this->superboid.getRadialReq(STEP);
-          std::valarray<real> force
-              = getFiniteForce(mini.radialDistance, beta, req);
-          this->_forceSum += force;
-        }
-      }
-  } else if (this->ID != 0u) {
-    Distance distance = (this->radialDistance);
-    // lest cost in -real than -Distance.
-    if (distance.module <= parameters().CORE_DIAMETER)
-      this->_forceSum
-          += -parameters().INFINITE_FORCE * distance.getDirectionArray();
-    else {
-      // lest cost in -real than -Distance.
-      const real beta = this->getHarrisParameter(
-          parameters().RADIAL_BETA, parameters().RADIAL_BETA_MEDIUM);
-      const real req            = this->superboid.getRadialReq(STEP);
-      std::valarray<real> force = getFiniteForce(distance, -beta, req);
-      this->_forceSum += force;
-    }
-  }
-
-  // Twist
-  for (const auto &tn : this->_twistNeighbors) {
-    const short int signal       = sign(tn.ANGLES[0u]);
-    const Miniboid &miniNeighbor = miniboidsInThisCell[tn.ID];
-    const real distanceBetween   = tn._distance.module;
-    std::valarray<real> tangent  = (this->radialDistance.getTangentArray());
-    if (distanceBetween <= parameters().CORE_DIAMETER) {
-      const std::valarray<real> f
-          = signal * parameters().INFINITE_FORCE * tangent;
-      this->_forceSum += f;
-    } else {
-      const real ANGLE_BETWEEN
-          = angleBetween(this->radialAngle, miniNeighbor.radialAngle);
-      const real SUBTRACTION = assertAngle(ANGLE_BETWEEN - tn.ANGLES[0u]);
-      const real kapa1       = this->getHarrisParameter(parameters().KAPA,
-                                                  parameters().KAPA_MEDIUM);
-      const real kapa2       = miniNeighbor.getHarrisParameter(
-          parameters().KAPA, parameters().KAPA_MEDIUM);
-      const real kapa = (kapa1 + kapa2) / 2.0f;
-      const real beta = this->getHarrisParameter(
-          parameters().TANGENT_BETA, parameters().TANGENT_BETA_MEDIUM);
-      const std::valarray<real> f1
-          = -kapa * SUBTRACTION * parameters().RADIAL_REQ[MY_TYPE] * tangent;
-      const std::vector<real> limits(
-          {parameters().TANGENT_PLASTIC_BEGIN[MY_TYPE],
-           parameters().TANGENT_PLASTIC_END[MY_TYPE]});  ////
-      const real req = this->superboid.getTangentReq(STEP);
-      const std::valarray<real> f2
-          = -getFiniteForce(tn._distance, beta, req, limits);
-      this->_forceSum += f1;
-      this->_forceSum += f2;
-    }
-  }
-
-  // Finalizing
-  const std::valarray<real> sum
-      = this->_noiseSum + this->_velocitySum + this->_forceSum;
-  const real module = getModule(sum);
-  if (module > 1.0e-6f)
-    this->newVelocity = (parameters().SPEED[MY_TYPE] / module) * sum;
-
-  return;
-}
-
-void
-    Miniboid::setNextPosition(const step_int step) {
-  // const step_int invasionCounter = step - this->_lastInvasionStep;;
-  this->velocity = this->newVelocity;
-  // if (invasionCounter > 0u && this->ID != 0u)
-  //   this->position = this->superboid.miniboids[0u].position - (1.1f *
-  //   parameters().CORE_DIAMETER * this->radialDistance.getDirectionArray());
-  // if (invasionCounter > 15u && this->ID != 0u)
-  //   this->position = this->superboid.miniboids[0u].position - (1.1f *
-  //   parameters().CORE_DIAMETER * this->radialDistance.getDirectionArray());
-  // else if (invasionCounter > 10u && this->ID != 0u)
-  //   this->position = this->superboid.miniboids[0u].position - (2.0f *
-  //   parameters().CORE_DIAMETER * this->radialDistance.getDirectionArray());
-  // else if (invasionCounter > 5u && this->ID != 0u)
-  //   this->position = this->superboid.miniboids[0u].position - (0.5f *
-  //   this->radialDistance.module * this->radialDistance.getDirectionArray());
-  // else
-  {
-    this->position
-        += parameters().DT
-           * this->velocity;  // Velocity is already normalized to V0.
-    // if (this->ID != 0 && !this->isVirtual)
-    //   this->position += this->radialDistance.getDirectionArray() *
-    //         ((this->superboid.area -
-    //         parameters().TARGET_AREA[this->superboid.type]) / (20.0f * TWO_PI
-    //         * this->superboid.meanRadius));
-  }
-
-  this->checkLimits(step);
+  // Superboid::setNextVelocity adds the radial and twist forces and
+  // finalizes newVelocity from the sums.
 
   return;
 }
@@ -646,44 +478,113 @@ void
     Miniboid::killBlackHoles(void) {
   if (this->ID != 0)
     return;
-  
-  for (const auto &pair : this->_neighbors)
-    for (const auto &nei : std::get<1>(pair))
-      if (nei.miniNeighbor.ID == 0)
-        if (nei.distance.module < 3.0 * parameters().CORE_DIAMETER)
-          this->superboid.setDeactivation("Black hole prevention");
-  
+
+  // Set by addNeighbor.
+  if (this->_blackHole)
+    this->superboid.setDeactivation("Black hole prevention");
+
+  return;
+}
+
+void
+    Miniboid::setVerletCandidates(void) {
+  const real cutoff = parameters().NEIGHBOR_DISTANCE + parameters().VERLET_SKIN;
+
+  this->_verletCandidates.clear();
+  for (auto box : this->_box->neighbors)
+    for (auto miniPointer : *box)
+      if (miniPointer->superboid.ID > this->superboid.ID  // Half list.
+          && miniPointer->superboid.isActivated() == true)
+        if (Distance(*this, *miniPointer).module <= cutoff)
+          this->_verletCandidates.push_back(miniPointer);
+  this->_verletPosition = this->position;
+
+  return;
+}
+
+void
+    Miniboid::addNeighbor(const Neighbor &neighbor) {
+  const super_int superID = neighbor.superboid->ID;
+  auto cell               = this->_neighbors.begin();
+  while (cell != this->_neighbors.end() && cell->superID < superID)
+    ++cell;
+  if (cell == this->_neighbors.end() || cell->superID != superID) {
+    cell = this->_neighbors.insert(cell, NeighborCell(superID));
+    this->superboid.cellNeighbors.insert(superID);
+  }
+  cell->insert(neighbor);
+
+  if (neighbor.ID == 0)
+    if (neighbor.distance.module < 3.0 * parameters().CORE_DIAMETER)
+      this->_blackHole = true;
+
+  return;
+}
+
+void
+    Miniboid::checkNeighbor(const Neighbor &neighbor) {
+  if (neighbor.superboid->ID != this->superboid.ID
+      && neighbor.superboid->isActivated() == true)
+    if (neighbor.distance.module <= parameters().NEIGHBOR_DISTANCE)
+      this->addNeighbor(neighbor);
+
   return;
 }
 
 void
     Miniboid::setNeighbors(const step_int step) {
   this->checkLimits(step);
-  this->_neighbors.clear();  // Removes all elements.
+  this->clearNeighbors();
 
   // Search for neighbors:
-  for (auto box : this->_box->neighbors)
-    for (auto miniPointer : box->miniboids)
-      if (miniPointer->superboid.ID != this->superboid.ID && miniPointer->superboid.isActivated() == true) {
-        //if (miniPointer->ID != 0u) {
-        const Miniboid &mini = *miniPointer;
-        Distance distance(*this, mini);
-        if (distance.module <= parameters().NEIGHBOR_DISTANCE) {
-          this->superboid.cellNeighbors.append(
-              mini.superboid.ID);  // Potential data race!!!!!!!!
-          ++(this->_neighborsPerTypeNos[mini.superboid.type]);  //// ERRADO?
-          std::list<Neighbor> &c = this->_neighbors[mini.superboid.ID];
-          c.emplace_back(mini, distance);
-        }
-      }
+  ReachFilter inReach(this->superboid, Vec2(this->position),
+                      parameters().NEIGHBOR_DISTANCE);
+  for (auto box : this->_box->neighbors) {
+    for (auto miniPointer : *box)
+      if (inReach(miniPointer->superboid))
+        this->checkNeighbor(
+            Neighbor(*miniPointer, Distance(*this, *miniPointer)));
+    for (auto miniPointer : box->virtuals())
+      if (inReach(*miniPointer->superboid))
+        this->checkNeighbor(
+            Neighbor(*miniPointer, Distance(*this, *miniPointer)));
+  }
 
-  // Sort each list in terms of distance:
-  for (auto &pair : this->_neighbors)
-    std::get<1>(pair).sort();
+  // Division, the only caller, runs serially.
+  static std::vector<const MembraneSegment *> segments;
+  getSegmentsInReach(*this, inReach, segments);
+  for (auto segment : segments) {
+    Distance distance;
+    if (segment->getDistance(*this, distance))
+      this->checkNeighbor(Neighbor(segment->first->superboid,
+                                   segment->first->ID, distance));
+  }
 
   return;
 }
 
+bool
+    MembraneSegment::getDistance(const Miniboid &mini,
+                                 Distance &distance) const {
+  const real fromX
+      = Distance::getMinimalImage(this->first->position[X] - mini.position[X]);
+  const real fromY
+      = Distance::getMinimalImage(this->first->position[Y] - mini.position[Y]);
+  const real edgeX = Distance::getMinimalImage(this->second->position[X]
+                                               - this->first->position[X]);
+  const real edgeY = Distance::getMinimalImage(this->second->position[Y]
+                                               - this->first->position[Y]);
+
+  // Closest point: first + t * edge.
+  const real t = -(fromX * edgeX + fromY * edgeY)
+                 / (square(edgeX) + square(edgeY));
+  if (!(t > 0.0f && t < 1.0f))
+    return false;
+
+  distance.set(fromX + t * edgeX, fromY + t * edgeY);
+  return true;
+}
+
 box_int
     Miniboid::boxID(void) const {
   return _box->ID;
@@ -710,14 +611,8 @@ void
   this->_forceSum            = 0.0f;
   this->_neighborsPerTypeNos = 0u;
 
-  if (this->ID != 0u || this->isVirtual) {
-    this->radialDistance = Distance(*this, this->superboid.miniboids[0u]);
-    this->radialAngle    = this->radialDistance.getAngle();
-  }
-
-  if (!this->isVirtual)
-    for (auto &tn : this->_twistNeighbors)
-      tn._distance = Distance(*this, this->superboid.miniboids[tn.ID]);
+  // radialDistance and the twist neighbor distances are set by
+  // Superboid::setRing.
 
   return;
 }
@@ -729,10 +624,10 @@ real
     std::cerr << "cacaca" << std::endl;
 #endif
 
-  const real DELTA_ANGLE = std::fabs(angleBetween(
-      this->radialDistance.getAngle(), miniNeighbor.radialDistance.getAngle()));
-  const real area        = std::sin(DELTA_ANGLE) * this->radialDistance.module
-                    * miniNeighbor.radialDistance.module * 0.5f;
+  const real area
+      = sineBetween(this->radialDistance, miniNeighbor.radialDistance)
+        * this->radialDistance.module * miniNeighbor.radialDistance.module
+        * 0.5f;
 
   return area;
 }
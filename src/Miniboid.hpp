@@ -5,14 +5,16 @@
 #pragma once
 #include <iostream>
 #include <list>
-#include <map>
 #include <tuple>
 #include <valarray>
+#include <vector>
 
 #include "CellNeighbors.hpp"
 #include "Distance.hpp"
 #include "Neighbor.hpp"
+#include "Particles.hpp"
 #include "TwistNeighbor.hpp"
+#include "Vec.hpp"
 #include "parameters.hpp"
 
 class Superboid;
@@ -20,25 +22,63 @@ bool
     operator==(const Superboid &s1, const Superboid &s2);
 class Box;
 
+// Point put between two peripheral miniboids of a superboid that are too far
+// apart, so that other superboids do not pass between them. It lives for one
+// step, has no velocity and looks for no neighbors, so a plain record is
+// enough.
+struct VirtualMiniboid {
+  Vec2 position;
+  Superboid *superboid;
+  Box *box;
+  mini_int ID;  // Index among the virtual miniboids of the superboid.
+
+  inline void setBox(Box *const b) { this->box = b; }
+  inline Box &getBox(void) const { return *(this->box); }
+  void checkLimits(const step_int step = 0);
+};
+
+class Miniboid;
+
+// Membrane edge between two peripheral miniboids of a superboid that are too
+// far apart, used instead of virtual miniboids when contact is segment. It is
+// put in every box its bounding box touches.
+struct MembraneSegment {
+  const Miniboid *first;
+  const Miniboid *second;
+  // Box coordinates of the lower corner of the bounding box, and boxes it
+  // touches along each dimension. Set by Box::fill.
+  box_int firstBox[Vec2::DIMENSIONS];
+  box_int boxesNo[Vec2::DIMENSIONS];
+
+  // Distance from mini to the closest point of the segment. False if that
+  // point is one of the ends, which are found as miniboids.
+  bool getDistance(const Miniboid &mini, Distance &distance) const;
+};
+
 class Miniboid {
  public:
-  const bool isVirtual;
   const mini_int ID;
   Superboid &superboid;
-  std::valarray<real> position;
-  std::valarray<real> velocity;
-  std::valarray<real> newVelocity;
+  ParticleVector position;
+  ParticleVector velocity;
+  ParticleVector newVelocity;
   Distance radialDistance;
-  real radialAngle;
 
   //  real angleCM;
   box_int boxID() const;  // ID of box where *this is.
   bool inEdge() const;    // True if box where *this is is in edge.
 
-  inline Miniboid(const mini_int _id, Superboid &super, const bool);
+  inline Miniboid(const mini_int _id, Superboid &super);
   void checkLimits(const step_int step = 0);
-  void setNextVelocity(const step_int);
-  void setNextPosition(const step_int);
+  void setNextVelocity(const step_int);  // Only the sums, see Superboid.
+  // Neighbors per type and the Harris parameters read by setNextVelocity,
+  // once the neighbors of the step are final.
+  void setHarrisParameters(void);
+  inline real radialBeta(void) const { return this->_radialBeta; }
+  inline real kapa(void) const { return this->_kapa; }
+  inline real tangentBeta(void) const { return this->_tangentBeta; }
+  // Index of a real miniboid in Particles.
+  static std::size_t getParticleID(const Superboid &, const mini_int id);
   void checkFatOut(void);
   void checkBackInTime(const step_int);
   inline void setBox(Box *const b) { _box = b; }
@@ -46,28 +86,59 @@ class Miniboid {
   inline Box *getBoxPtr(void) const { return this->_box; }
   void reset(void);
   real getAreaBetween(const Miniboid &) const;
+  // Full search in the boxes around, for a single miniboid. The step uses
+  // PairSearch instead.
   void setNeighbors(const step_int);
+  inline void clearNeighbors(void) {
+    this->_neighbors.clear();  // Keeps capacity.
+    this->_blackHole = false;
+    return;
+  }
+  void addNeighbor(const Neighbor &);
+  // Real miniboids within NEIGHBOR_DISTANCE + VERLET_SKIN of the superboids
+  // with bigger ID, so every pair is kept by one side only.
+  void setVerletCandidates(void);
+  inline const std::vector<const Miniboid *> &verletCandidates(void) const {
+    return this->_verletCandidates;
+  }
+  inline real getVerletDisplacement(void) const {
+    Distance d;
+    d.set(this->position[X] - this->_verletPosition[X],
+          this->position[Y] - this->_verletPosition[Y]);
+    return d.module;
+  }
+  inline void shiftVerletPosition(const Vec2 &delta) {
+    this->_verletPosition += delta;
+  }
   std::list<TwistNeighbor> _twistNeighbors;
-  bool isInSomeNthTriangle(const mini_int nth, const Superboid &super);
-  bool fatInteractions(const step_int, const std::list<Neighbor> &,
+  bool fatInteractions(const step_int, const NeighborCell &,
                        const bool interact);
-  std::map<super_int, std::list<Neighbor>>
-      _neighbors;  // From different superboid.
+  // From different superboids, sorted by superboid ID.
+  std::vector<NeighborCell> _neighbors;
   friend void exportPositions(const std::vector<Superboid> &, const step_int);
   void killBlackHoles(void);
 
  protected:
   std::list<std::tuple<step_int, std::vector<const Miniboid *>>> history;
-  std::valarray<real> _oldPosition;
+  ParticleVector _oldPosition;
   step_int _lastInvasionStep;
-  std::valarray<real> _noiseSum;     // Related to ETA.
-  std::valarray<real> _velocitySum;  // Related to ALPHA;
-  std::valarray<real> _forceSum;     // Related to BETA.
+  ParticleVector _noiseSum;     // Related to ETA.
+  ParticleVector _velocitySum;  // Related to ALPHA;
+  ParticleVector _forceSum;     // Related to BETA.
   Box *_box;
-  std::valarray<mini_int> _neighborsPerTypeNos;
-  void noise(void);
-  void checkNeighbor(Miniboid &neighbor);
-  static std::valarray<real> getAngles(const mini_int id);
+  bool _blackHole;  // Some nucleus among neighbors is too close.
+  std::valarray<mini_int> _neighborsPerTypeNos;  // Set with the below.
+  // Harris parameters of this step, set by setHarrisParameters.
+  real _radialBeta;
+  real _kapa;
+  real _tangentBeta;
+  std::vector<const Miniboid *> _verletCandidates;
+  Vec2 _verletPosition;  // Where candidates were last set.
+  void checkNeighbor(const Neighbor &);
+  static VecN<1u> getAngles(const mini_int id);
+  inline ParticleVector getField(const ParticleField field) const {
+    return Particles::view(field, getParticleID(this->superboid, this->ID));
+  }
   inline Miniboid(void); /* Declared but intentionally not defined. */
   void setNewVelocity(void);
   void interInteractions(const step_int);
@@ -76,37 +147,39 @@ class Miniboid {
   void checkRectangularLimits(void);
   void checkStokesLimits(void);
   void checkKillCondition(const step_int);
-  real getHarrisParameter(const std::vector<std::vector<real>> &,
-                          const std::vector<real> &medium) const;
+  // From the sum of the weights of the total of neighbors, by type.
+  real getHarrisParameter(real sum, const real medium,
+                          const mini_int total) const;
 };
 
-inline Miniboid::Miniboid(const mini_int _id, Superboid &super,
-                          const bool isVirt = false)
-    : isVirtual(isVirt)
-    , ID(_id)
+inline Miniboid::Miniboid(const mini_int _id, Superboid &super)
+    : ID(_id)
     , superboid(super)
-    , position(parameters().DIMENSIONS)
-    , velocity(parameters().DIMENSIONS)
-    , newVelocity(parameters().DIMENSIONS)
+    , position(this->getField(ParticleField::POSITION))
+    , velocity(this->getField(ParticleField::VELOCITY))
+    , newVelocity(this->getField(ParticleField::NEW_VELOCITY))
     , radialDistance(Distance())
-    , _oldPosition(parameters().DIMENSIONS)
+    , _oldPosition(this->getField(ParticleField::OLD_POSITION))
     , _lastInvasionStep(0)
-    , _noiseSum(parameters().DIMENSIONS)
-    , _velocitySum(parameters().DIMENSIONS)
-    , _forceSum(parameters().DIMENSIONS)
+    , _noiseSum(this->getField(ParticleField::NOISE_SUM))
+    , _velocitySum(this->getField(ParticleField::VELOCITY_SUM))
+    , _forceSum(this->getField(ParticleField::FORCE_SUM))
     , _box(nullptr)
-    , _neighborsPerTypeNos(parameters().TYPES_NO) {
-  if (!this->isVirtual) {
-    this->setNewVelocity();
-    if (_id != 0u) {
-      if (parameters().MINIBOIDS_PER_SUPERBOID > 3u
-          || _id != parameters().MINIBOIDS_PER_SUPERBOID - 1u)
-        this->_twistNeighbors.push_front(
-            TwistNeighbor(_id, getTangentNeighborID(_id, 1)));
-      if (parameters().MINIBOIDS_PER_SUPERBOID > 3u || _id != 1u)
-        this->_twistNeighbors.push_front(
-            TwistNeighbor(_id, getTangentNeighborID(_id, -1)));
-    }
+    , _blackHole(false)
+    , _neighborsPerTypeNos(parameters().TYPES_NO)
+    , _radialBeta(-0.0f)
+    , _kapa(-0.0f)
+    , _tangentBeta(-0.0f)
+    , _verletPosition() {
+  this->setNewVelocity();
+  if (_id != 0u) {
+    if (parameters().MINIBOIDS_PER_SUPERBOID > 3u
+        || _id != parameters().MINIBOIDS_PER_SUPERBOID - 1u)
+      this->_twistNeighbors.push_front(
+          TwistNeighbor(_id, getTangentNeighborID(_id, 1)));
+    if (parameters().MINIBOIDS_PER_SUPERBOID > 3u || _id != 1u)
+      this->_twistNeighbors.push_front(
+          TwistNeighbor(_id, getTangentNeighborID(_id, -1)));
   }
 
   return;
@@ -117,21 +190,10 @@ extern std::ostream &
 
 inline bool
     operator==(const Miniboid &m1, const Miniboid &m2) {
-  return (m1.ID == m2.ID && m1.isVirtual == m2.isVirtual
-          && m1.superboid == m2.superboid);
+  return (m1.ID == m2.ID && m1.superboid == m2.superboid);
 }
 
 inline bool
     operator!=(const Miniboid &m1, const Miniboid &m2) {
   return !(m1 == m2);
 }
-
-bool
-    isPointInTriangle(const std::valarray<real> &p_test,
-                      const std::valarray<real> &p0,
-                      const std::valarray<real> &p1,
-                      const std::valarray<real> &p2);
-bool
-    isPointInSomeNthTriangle(const mini_int nth,
-                             const std::valarray<real> &point,
-                             const Superboid &super);
@@ -4,15 +4,35 @@
 
 #include "Neighbor.hpp"
 
+#include <utility>
+
 #include "Miniboid.hpp"
 
 Neighbor::Neighbor(const Miniboid &m, const Distance &d)
-    : miniNeighbor(m), distance(d) {
+    : miniNeighbor(&m)
+    , virtualNeighbor(nullptr)
+    , superboid(&m.superboid)
+    , ID(m.ID)
+    , distance(d) {
+  return;
+}
+
+Neighbor::Neighbor(const VirtualMiniboid &m, const Distance &d)
+    : miniNeighbor(nullptr)
+    , virtualNeighbor(&m)
+    , superboid(m.superboid)
+    , ID(m.ID)
+    , distance(d) {
   return;
 }
 
-Neighbor::Neighbor(const Distance &d, const Miniboid &m)
-    : miniNeighbor(m), distance(d) {
+Neighbor::Neighbor(const Superboid &super, const mini_int id,
+                   const Distance &d)
+    : miniNeighbor(nullptr)
+    , virtualNeighbor(nullptr)
+    , superboid(&super)
+    , ID(id)
+    , distance(d) {
   return;
 }
 
@@ -20,3 +40,26 @@ bool
     operator<(const Neighbor &n1, const Neighbor &n2) {
   return n1.distance.module < n2.distance.module;
 }
+
+NeighborCell::NeighborCell(const super_int id)
+    : superID(id), count(0u), size(0u) {
+  return;
+}
+
+void
+    NeighborCell::insert(const Neighbor &neighbor) {
+  ++this->count;
+
+  // Ties keep the neighbor inserted first.
+  if (this->size < 2u)
+    this->nearest[this->size++] = neighbor;
+  else if (neighbor < this->nearest[1])
+    this->nearest[1] = neighbor;
+  else
+    return;
+
+  if (this->size == 2u && this->nearest[1] < this->nearest[0])
+    std::swap(this->nearest[0], this->nearest[1]);
+
+  return;
+}
@@ -5,14 +5,50 @@
 #pragma once
 #include "Distance.hpp"
 class Miniboid;
+class Superboid;
+struct VirtualMiniboid;
 
 class Neighbor {
  public:
-  const Miniboid &miniNeighbor;
-  const Distance distance;
+  const Miniboid *miniNeighbor;            // Null if virtual.
+  const VirtualMiniboid *virtualNeighbor;  // Null if real.
+  const Superboid *superboid;              // Of either.
+  mini_int ID;                             // Of either.
+  Distance distance;
+  inline Neighbor(void)
+      : miniNeighbor(nullptr)
+      , virtualNeighbor(nullptr)
+      , superboid(nullptr)
+      , ID(0u)
+      , distance() {
+    return;
+  }
   Neighbor(const Miniboid &, const Distance &);
-  Neighbor(const Distance &, const Miniboid &);
+  Neighbor(const VirtualMiniboid &, const Distance &);
+  // Neither real nor virtual: a point of superboid super taken as miniboid
+  // id.
+  Neighbor(const Superboid &super, const mini_int id, const Distance &);
 };
 
 bool
     operator<(const Neighbor &, const Neighbor &);
+
+// Neighbors of a miniboid from one other superboid. Interactions only use the
+// two nearest of them, so only those are kept, sorted by distance.
+class NeighborCell {
+ public:
+  super_int superID;
+  mini_int count;  // All neighbors found in the superboid.
+  mini_int size;   // Neighbors kept, up to 2.
+  Neighbor nearest[2];
+
+  explicit NeighborCell(const super_int id);
+  void insert(const Neighbor &);
+  inline bool empty(void) const { return this->size == 0u; }
+  inline const Neighbor &front(void) const { return this->nearest[0]; }
+  inline void clear(void) {
+    this->count = 0u;
+    this->size  = 0u;
+    return;
+  }
+};
@@ -0,0 +1,189 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#include "PairSearch.hpp"
+
+#include "Box.hpp"
+#include "Miniboid.hpp"
+#include "Superboid.hpp"
+
+// Boxes taken at once by a thread in searchBoxes.
+static const box_int BOXES_PER_CHUNK = 16u;
+
+// Box neighbors visited from each box. The other four are visited from the
+// opposite side.
+static const CardinalPoint HALF_SHELL[] = {
+    CardinalPoint::EAST, CardinalPoint::NORTH, CardinalPoint::NORTHEAST,
+    CardinalPoint::NORTHWEST};
+
+PairSearch::PairSearch(void) : _threadsNo(0u), _nextBox(0u) {
+  return;
+}
+
+void
+    PairSearch::set(const thread_int threadsNo) {
+  if (this->_threadsNo != threadsNo) {
+    this->_threadsNo = threadsNo;
+    this->_buffers.assign(threadsNo, std::vector<std::vector<Record>>(threadsNo));
+    this->_seen.assign(threadsNo, std::vector<const MembraneSegment *>());
+  }
+
+  for (auto &row : this->_buffers)
+    for (auto &buffer : row)
+      buffer.clear();
+  this->rewind();
+
+  return;
+}
+
+void
+    PairSearch::push(const thread_int THREAD_ID, const Miniboid &mini,
+                     const Neighbor &neighbor) {
+  const thread_int owner = mini.superboid.ID % this->_threadsNo;
+  this->_buffers[THREAD_ID][owner].push_back(
+      Record({mini.superboid.ID, mini.ID, neighbor}));
+
+  return;
+}
+
+void
+    PairSearch::measure(const thread_int THREAD_ID, const Miniboid &miniA,
+                        const Miniboid &miniB) {
+  if (miniA.superboid.ID == miniB.superboid.ID)
+    return;
+  if (!miniA.superboid.isActivated() || !miniB.superboid.isActivated())
+    return;
+
+  const Distance distance(miniA, miniB);
+  if (distance.module > parameters().NEIGHBOR_DISTANCE)
+    return;
+
+  this->push(THREAD_ID, miniA, Neighbor(miniB, distance));
+  Distance opposite  = -distance;
+  opposite.miniboid1 = &miniB;
+  opposite.miniboid2 = &miniA;
+  this->push(THREAD_ID, miniB, Neighbor(miniA, opposite));
+
+  return;
+}
+
+void
+    PairSearch::measure(const thread_int THREAD_ID, const Miniboid &mini,
+                        const VirtualMiniboid &virtualMini) {
+  if (mini.superboid.ID == virtualMini.superboid->ID)
+    return;
+  if (!mini.superboid.isActivated() || !virtualMini.superboid->isActivated())
+    return;
+
+  const Distance distance(mini, virtualMini);
+  if (distance.module > parameters().NEIGHBOR_DISTANCE)
+    return;
+
+  this->push(THREAD_ID, mini, Neighbor(virtualMini, distance));
+
+  return;
+}
+
+void
+    PairSearch::measure(const thread_int THREAD_ID, const Miniboid &mini,
+                        const MembraneSegment &segment) {
+  const Superboid &super = segment.first->superboid;
+  if (mini.superboid.ID == super.ID)
+    return;
+  if (!mini.superboid.isActivated() || !super.isActivated())
+    return;
+
+  Distance distance;
+  if (!segment.getDistance(mini, distance))
+    return;
+  if (distance.module > parameters().NEIGHBOR_DISTANCE)
+    return;
+
+  // Taken as the first end, without velocity.
+  this->push(THREAD_ID, mini, Neighbor(super, segment.first->ID, distance));
+
+  return;
+}
+
+void
+    PairSearch::searchBoxes(const thread_int THREAD_ID,
+                            const std::vector<Box> &boxes) {
+  while (true) {
+    const box_int first = this->_nextBox.fetch_add(BOXES_PER_CHUNK);
+    if (first >= boxes.size())
+      return;
+    const box_int last = first + BOXES_PER_CHUNK < boxes.size()
+                             ? first + BOXES_PER_CHUNK
+                             : boxes.size();
+
+    for (box_int boxID = first; boxID < last; ++boxID) {
+      const Box &box = boxes[boxID];
+      for (auto miniA = box.begin(); miniA != box.end(); ++miniA)
+        for (auto miniB = miniA + 1; miniB != box.end(); ++miniB)
+          this->measure(THREAD_ID, **miniA, **miniB);
+      for (auto miniA : box)
+        for (auto miniB : box.virtuals())
+          this->measure(THREAD_ID, *miniA, *miniB);
+
+      // Virtual miniboids are only paired with real ones.
+      for (const auto cardinal : HALF_SHELL) {
+        const Box &other = *box.neighbors[static_cast<uint16_t>(cardinal)];
+        for (auto miniA : box) {
+          for (auto miniB : other)
+            this->measure(THREAD_ID, *miniA, *miniB);
+          for (auto miniB : other.virtuals())
+            this->measure(THREAD_ID, *miniA, *miniB);
+        }
+        for (auto miniA : box.virtuals())
+          for (auto miniB : other)
+            this->measure(THREAD_ID, *miniB, *miniA);
+      }
+    }
+  }
+}
+
+void
+    PairSearch::searchCandidates(const thread_int THREAD_ID,
+                                 Superboid &superboid) {
+  for (const auto &mini : superboid.miniboids) {
+    ReachFilter inReach(superboid, Vec2(mini.position),
+                        parameters().NEIGHBOR_DISTANCE);
+    for (auto candidate : mini.verletCandidates())
+      if (inReach(candidate->superboid))
+        this->measure(THREAD_ID, mini, *candidate);
+
+    for (auto box : mini.getBox().neighbors)
+      for (auto miniPointer : box->virtuals())
+        if (inReach(*miniPointer->superboid))
+          this->measure(THREAD_ID, mini, *miniPointer);
+  }
+
+  return;
+}
+
+void
+    PairSearch::searchSegments(const thread_int THREAD_ID,
+                               Superboid &superboid) {
+  std::vector<const MembraneSegment *> &seen = this->_seen[THREAD_ID];
+  for (const auto &mini : superboid.miniboids) {
+    ReachFilter inReach(superboid, Vec2(mini.position),
+                        parameters().NEIGHBOR_DISTANCE);
+    getSegmentsInReach(mini, inReach, seen);
+    for (auto segment : seen)
+      this->measure(THREAD_ID, mini, *segment);
+  }
+
+  return;
+}
+
+void
+    PairSearch::scatter(const thread_int THREAD_ID,
+                        std::vector<Superboid> &superboids) {
+  for (const auto &row : this->_buffers)
+    for (const auto &record : row[THREAD_ID])
+      superboids[record.superID].miniboids[record.miniID].addNeighbor(
+          record.neighbor);
+
+  return;
+}
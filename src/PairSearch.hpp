@@ -0,0 +1,66 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "Neighbor.hpp"
+#include "parameters.hpp"
+
+class Box;
+class Miniboid;
+class Superboid;
+struct VirtualMiniboid;
+struct MembraneSegment;
+
+// Inter-cell neighbor search measuring every pair of miniboids only once.
+// Threads do not write neighbors directly: each pair found becomes one record
+// per real miniboid of the pair, buffered by the thread owning the cell of
+// that miniboid (cell ID % threads). scatter() then lets every thread insert
+// only the records of the cells it owns, so no miniboid is written by two
+// threads.
+class PairSearch {
+ public:
+  PairSearch(void);
+  // Resize the buffers and forget the records of the last search.
+  void set(const thread_int threadsNo);
+  // Half-shell traversal: every box is paired with itself and with its east,
+  // north, northeast and northwest neighbors. Bounding circles are not
+  // checked: a box holds runs of about two miniboids of a cell, so the check
+  // costs as much as the distances it would save.
+  inline void rewind(void) { this->_nextBox.store(0u); }
+  void searchBoxes(const thread_int THREAD_ID, const std::vector<Box> &);
+  // Verlet candidates (each pair kept by one side only) plus the virtual
+  // miniboids in the boxes around the superboid. Cells out of reach are
+  // rejected by their bounding circles, counted in the superboid.
+  void searchCandidates(const thread_int THREAD_ID, Superboid &);
+  // Membrane segments in the boxes around the superboid, rejected the same
+  // way.
+  void searchSegments(const thread_int THREAD_ID, Superboid &);
+  void scatter(const thread_int THREAD_ID, std::vector<Superboid> &);
+
+ protected:
+  struct Record {
+    super_int superID;  // Miniboid getting the neighbor.
+    mini_int miniID;
+    Neighbor neighbor;  // Distance from the miniboid to the neighbor.
+  };
+
+  thread_int _threadsNo;
+  // Records found by thread [i] for the cells owned by thread [j].
+  std::vector<std::vector<std::vector<Record>>> _buffers;
+  std::atomic<box_int> _nextBox;
+  // [thread]: segments already measured for the current miniboid.
+  std::vector<std::vector<const MembraneSegment *>> _seen;
+
+  void measure(const thread_int THREAD_ID, const Miniboid &, const Miniboid &);
+  // Virtual miniboids do not look for neighbors.
+  void measure(const thread_int THREAD_ID, const Miniboid &,
+               const VirtualMiniboid &);
+  void measure(const thread_int THREAD_ID, const Miniboid &,
+               const MembraneSegment &);
+  void push(const thread_int THREAD_ID, const Miniboid &, const Neighbor &);
+  PairSearch(const PairSearch &) = delete;
+};
@@ -95,7 +95,9 @@ void
   string_set.emplace_back("boundary", false, "periodic");
   string_set.emplace_back("initial", false, "hex_center");
   string_set.emplace_back("kill", false, "none");
+  string_set.emplace_back("contact", false, "virtual");
   string_set.emplace_back("initial_velocity_angle", false, "random");
+  string_set.emplace_back("seed", false, "time");
 
   auto &uint_set = Parameter<unsigned long int>::map;
   uint_set.emplace_back("dimensions", false, "2");
@@ -116,6 +118,7 @@ void
   real_set.back().pushDependency("dimensions");
   real_set.emplace_back("division_region_x", false, "0");
   real_set.emplace_back("neighbor_distance", false, "1.1");
+  real_set.emplace_back("verlet_skin", false, "0");
   real_set.emplace_back("initial_distance", true, "2");
   real_set.emplace_back("core_diameter", true, "0.2");
   real_set.emplace_back("core_intensity", true, "1000");
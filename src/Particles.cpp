@@ -0,0 +1,36 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#include "Particles.hpp"
+
+std::vector<real> Particles::_data;
+std::vector<box_int> Particles::_boxCoordinates;
+std::size_t Particles::_particlesNo(0u);
+
+/******************************
+ *  ParticleVector methods:  *
+ ******************************/
+
+std::ostream &
+    operator<<(std::ostream &os, const ParticleVector &pv) {
+  for (const auto &component : pv)
+    os << std::fixed << component << '\t';
+
+  return os;
+}
+
+/************************
+ *  Particles methods:  *
+ ************************/
+
+void
+    Particles::allocate(const std::size_t particlesNo) {
+  _particlesNo = particlesNo;
+  _data.assign(static_cast<std::size_t>(ParticleField::FIELDS_NO)
+                   * Vec2::DIMENSIONS * particlesNo,
+               -0.0f);
+  _boxCoordinates.assign(Vec2::DIMENSIONS * particlesNo, 0u);
+
+  return;
+}
@@ -0,0 +1,179 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "Vec.hpp"
+#include "parameters.hpp"
+
+// Vector fields of a miniboid.
+enum class ParticleField : uint16_t {
+  POSITION,
+  VELOCITY,
+  NEW_VELOCITY,
+  OLD_POSITION,
+  NOISE_SUM,     // Related to ETA.
+  VELOCITY_SUM,  // Related to ALPHA.
+  FORCE_SUM,     // Related to BETA.
+  FIELDS_NO
+};
+
+// View of one vector field of one particle, whose components are stride
+// reals apart. Copying a ParticleVector copies the view, assigning to it
+// copies the components.
+class ParticleVector {
+ public:
+  class Iterator {
+   public:
+    inline Iterator(real *component, const std::size_t stride)
+        : _component(component), _stride(stride) {
+      return;
+    }
+    inline real &operator*(void) const { return *this->_component; }
+    inline Iterator &operator++(void) {
+      this->_component += this->_stride;
+      return *this;
+    }
+    inline bool operator!=(const Iterator &it) const {
+      return this->_component != it._component;
+    }
+
+   protected:
+    real *_component;
+    std::size_t _stride;
+  };
+
+  inline ParticleVector(real *first, const std::size_t stride)
+      : _first(first), _stride(stride) {
+    return;
+  }
+  ParticleVector(const ParticleVector &) = default;
+
+  inline real &operator[](const std::size_t dim) {
+    return this->_first[dim * this->_stride];
+  }
+  inline const real &operator[](const std::size_t dim) const {
+    return this->_first[dim * this->_stride];
+  }
+  static constexpr std::size_t size(void) { return Vec2::DIMENSIONS; }
+  inline Iterator begin(void) const {
+    return Iterator(this->_first, this->_stride);
+  }
+  inline Iterator end(void) const {
+    return Iterator(this->_first + this->size() * this->_stride, this->_stride);
+  }
+
+  inline ParticleVector &operator=(const ParticleVector &pv) {
+    return this->assign(pv);
+  }
+  inline ParticleVector &operator=(const Vec2 &v) { return this->assign(v); }
+  inline ParticleVector &operator=(const real r) {
+    return this->assign(Vec2(r));
+  }
+  template<typename Array>
+  inline ParticleVector &operator+=(const Array &array) {
+    for (dimension_int dim = 0u; dim < this->size(); ++dim)
+      (*this)[dim] += array[dim];
+    return *this;
+  }
+  template<typename Array>
+  inline ParticleVector &operator-=(const Array &array) {
+    for (dimension_int dim = 0u; dim < this->size(); ++dim)
+      (*this)[dim] -= array[dim];
+    return *this;
+  }
+  inline ParticleVector &operator*=(const real r) {
+    for (dimension_int dim = 0u; dim < this->size(); ++dim)
+      (*this)[dim] *= r;
+    return *this;
+  }
+  inline ParticleVector &operator/=(const real r) {
+    for (dimension_int dim = 0u; dim < this->size(); ++dim)
+      (*this)[dim] /= r;
+    return *this;
+  }
+
+ protected:
+  real *_first;
+  std::size_t _stride;
+
+  template<typename Array>
+  inline ParticleVector &assign(const Array &array) {
+    for (dimension_int dim = 0u; dim < this->size(); ++dim)
+      (*this)[dim] = array[dim];
+    return *this;
+  }
+};
+
+// Arithmetic on views yields values.
+inline Vec2
+    operator+(const ParticleVector &pv1, const ParticleVector &pv2) {
+  return Vec2(pv1) += pv2;
+}
+inline Vec2
+    operator+(const ParticleVector &pv, const Vec2 &v) {
+  return Vec2(pv) += v;
+}
+inline Vec2
+    operator+(const Vec2 &v, const ParticleVector &pv) {
+  return Vec2(v) += pv;
+}
+inline Vec2
+    operator-(const ParticleVector &pv1, const ParticleVector &pv2) {
+  return Vec2(pv1) -= pv2;
+}
+inline Vec2
+    operator-(const ParticleVector &pv, const Vec2 &v) {
+  return Vec2(pv) -= v;
+}
+inline Vec2
+    operator-(const Vec2 &v, const ParticleVector &pv) {
+  return Vec2(v) -= pv;
+}
+inline Vec2 operator*(const real r, const ParticleVector &pv) {
+  return Vec2(pv) *= r;
+}
+inline Vec2 operator*(const ParticleVector &pv, const real r) {
+  return Vec2(pv) *= r;
+}
+inline Vec2
+    operator/(const ParticleVector &pv, const real r) {
+  return Vec2(pv) /= r;
+}
+std::ostream &
+    operator<<(std::ostream &, const ParticleVector &);
+
+// Structure of arrays holding the vector fields of every real miniboid. The
+// particle ID of miniboid m of superboid s is s * MINIBOIDS_PER_SUPERBOID + m,
+// so the miniboids of a superboid are contiguous in every array. Virtual
+// miniboids are not particles here, see VirtualMiniboid.
+class Particles {
+ public:
+  static void allocate(const std::size_t particlesNo);
+  static inline std::size_t size(void) { return _particlesNo; }
+  // First element of the array of one component of a field.
+  static inline real *get(const ParticleField field, const dimension_int dim) {
+    return _data.data()
+           + (static_cast<std::size_t>(field) * Vec2::DIMENSIONS + dim)
+                 * _particlesNo;
+  }
+  // View of a field of particle particleID.
+  static inline ParticleVector view(const ParticleField field,
+                                    const std::size_t particleID) {
+    return ParticleVector(get(field, X) + particleID, _particlesNo);
+  }
+  // First element of the array of box coordinates along dim, as last set by
+  // Box::fill.
+  static inline box_int *getBoxCoordinate(const dimension_int dim) {
+    return _boxCoordinates.data() + dim * _particlesNo;
+  }
+
+ protected:
+  static std::vector<real> _data;
+  static std::vector<box_int> _boxCoordinates;
+  static std::size_t _particlesNo;
+};
@@ -0,0 +1,59 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#include "Schedule.hpp"
+
+#include "Superboid.hpp"
+
+// Chunks per thread. More chunks balance better but cost more atomic
+// operations.
+static const std::size_t CHUNKS_PER_THREAD = 4u;
+
+Schedule::Schedule(void) : _nextChunk(0u) {
+  return;
+}
+
+void
+    Schedule::set(const std::vector<Superboid> &superboids,
+                  const thread_int threadsNo) {
+  this->_cells.clear();
+  this->_chunkBegins.clear();
+
+  step_int totalWorkload = 0u;
+  for (const auto superID : Superboid::activated()) {
+    this->_cells.push_back(superID);
+    totalWorkload += superboids[superID].workload();
+  }
+
+  const step_int chunksNo  = CHUNKS_PER_THREAD * threadsNo;
+  const step_int chunkLoad = (totalWorkload + chunksNo - 1u) / chunksNo;
+
+  step_int load = 0u;
+  this->_chunkBegins.push_back(0u);
+  for (std::size_t index = 0u; index < this->_cells.size(); ++index) {
+    load += superboids[this->_cells[index]].workload();
+    if (load >= chunkLoad && index + 1u < this->_cells.size()) {
+      this->_chunkBegins.push_back(index + 1u);
+      load = 0u;
+    }
+  }
+  this->_chunkBegins.push_back(this->_cells.size());
+
+  this->rewind();
+
+  return;
+}
+
+bool
+    Schedule::next(std::size_t &begin, std::size_t &end) {
+  const std::size_t chunk
+      = this->_nextChunk.fetch_add(1u, std::memory_order_relaxed);
+  if (chunk + 1u >= this->_chunkBegins.size())
+    return false;
+
+  begin = this->_chunkBegins[chunk];
+  end   = this->_chunkBegins[chunk + 1u];
+
+  return true;
+}
@@ -0,0 +1,32 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <atomic>
+#include <vector>
+
+#include "parameters.hpp"
+
+class Superboid;
+
+// Dynamic partition of the activated cells of a step. Cells are grouped in
+// contiguous chunks of roughly the same workload (see Superboid::workload)
+// and threads grab the next free chunk until none is left.
+class Schedule {
+ public:
+  Schedule(void);
+  void set(const std::vector<Superboid> &, const thread_int threadsNo);
+  inline void rewind(void) { this->_nextChunk.store(0u); }
+  bool next(std::size_t &begin, std::size_t &end);
+  inline super_int operator[](const std::size_t index) const {
+    return this->_cells[index];
+  }
+  inline std::size_t size(void) const { return this->_cells.size(); }
+
+ protected:
+  std::vector<super_int> _cells;
+  std::vector<std::size_t> _chunkBegins;  // Last element is _cells.size().
+  std::atomic<std::size_t> _nextChunk;
+  Schedule(const Schedule &) = delete;
+};
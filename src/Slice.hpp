@@ -0,0 +1,20 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <cstddef>
+
+// Contiguous part of an array owned by somebody else.
+template<typename T>
+class Slice {
+ public:
+  inline Slice(T *first, T *last) : _first(first), _last(last) { return; }
+  inline T *begin(void) const { return this->_first; }
+  inline T *end(void) const { return this->_last; }
+  inline std::size_t size(void) const { return this->_last - this->_first; }
+
+ protected:
+  T *_first;
+  T *_last;
+};
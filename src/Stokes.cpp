@@ -10,14 +10,14 @@
 #include "Distance.hpp"
 
 static std::vector<box_int>
-    getBoxIDs(const std::valarray<real> &center, const real radius) {
+    getBoxIDs(const Vec2 &center, const real radius) {
   std::vector<box_int> boxes;
 
   real tmpRadius   = radius;
   const real delta = parameters().RANGE / parameters().BOXES_IN_EDGE;
   while (tmpRadius > 0.0f) {
     for (unsigned i = 0u; i < 3141u; ++i) {
-      std::valarray<real> point = center;
+      Vec2 point = center;
       const real angle          = i * TWO_PI / 3141.0f;
       point[X] += radius * std::cos(angle);
       point[Y] += radius * std::sin(angle);
@@ -33,13 +33,13 @@ static std::vector<box_int>
   return boxes;
 }
 
-Stokes::Stokes(std::valarray<real> _center, real _radius)
+Stokes::Stokes(Vec2 _center, real _radius)
     : center(_center), radius(_radius), boxIDs(getBoxIDs(_center, _radius)) {
   return;
 }
 
 bool
-    Stokes::contains(const std::valarray<real> &position) const {
+    Stokes::contains(const Vec2 &position) const {
   const real TOLERABLE = this->radius + parameters().REAL_TOLERANCE;
   const Distance d(this->center, position);
   return d.module < TOLERABLE;
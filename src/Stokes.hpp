@@ -3,15 +3,15 @@
 // License specified in LICENSE file.
 
 #pragma once
-#include <valarray>
+#include "Vec.hpp"
 
 #include "parameters.hpp"
 
 class Stokes {
  public:
-  Stokes(std::valarray<real> _center, real _radius);
-  const std::valarray<real> center;
+  Stokes(Vec2 _center, real _radius);
+  const Vec2 center;
   const real radius;
   const std::vector<box_int> boxIDs;
-  bool contains(const std::valarray<real> &position) const;
+  bool contains(const Vec2 &position) const;
 };
@@ -4,24 +4,142 @@
 
 #include "Superboid.hpp"
 
-#include <ctime>
-#include <random>
+#include <algorithm>
 #include <vector>
 
 #include "Box.hpp"
 #include "Miniboid.hpp"
 #include "Stokes.hpp"
+#include "elastic_plastic.hpp"
 #include "export.hpp"
 #include "initial.hpp"
 #include "nextstep.hpp"
 #include "parameters.hpp"
+#include "random.hpp"
 
-unsigned long long int
-    getSeed(const super_int id) {
-  return std::time(NULL) + id;
+super_int Superboid::_totalSuperboids(0u);
+std::vector<super_int> Superboid::_activated;
+std::vector<std::vector<VirtualMiniboid>> Superboid::_virtualPools;
+
+// Fields of Superboid::_ring. Spokes go from a peripheral miniboid to the
+// nucleus, edges from a peripheral miniboid to the next one along the ring.
+enum class RingField : uint16_t {
+  SPOKE_COSINE,
+  SPOKE_SINE,
+  SPOKE_MODULE,
+  EDGE_COSINE,
+  EDGE_SINE,
+  EDGE_MODULE,
+  EDGE_ANGLE,     // From the spoke to the spoke of the next miniboid.
+  RADIAL_BETA,    // Harris parameters of the step, gathered.
+  RADIAL_FORCE_X, // On the nucleus, minus on the peripheral miniboid.
+  RADIAL_FORCE_Y,
+  FIELDS_NO
+};
+
+static inline real *
+    getRingField(std::vector<real> &ring, const RingField field,
+                 const mini_int n) {
+  return ring.data() + static_cast<std::size_t>(field) * n;
 }
 
-super_int Superboid::_totalSuperboids(0u);
+// Same as Distance::set.
+static inline void
+    setRingDistance(real deltaX, real deltaY, real &cosine, real &sine,
+                    real &module) {
+  deltaX = Distance::getMinimalImage(deltaX);
+  deltaY = Distance::getMinimalImage(deltaY);
+  module = std::sqrt(square(deltaX) + square(deltaY));
+  cosine = module > 1.0e-6 ? deltaX / module : -0.0f;
+  sine   = module > 1.0e-6 ? deltaY / module : -0.0f;
+
+  return;
+}
+
+// Ring geometry of n = N miniboids, N = 0 standing for any
+// MINIBOIDS_PER_SUPERBOID. With N known, the loops are unrolled and
+// vectorized.
+template<mini_int N>
+static void
+    setRingGeometry(const real *x, const real *y, std::vector<real> &ring) {
+  const mini_int n = N != 0u ? N : parameters().MINIBOIDS_PER_SUPERBOID;
+  real *spokeCosine = getRingField(ring, RingField::SPOKE_COSINE, n);
+  real *spokeSine   = getRingField(ring, RingField::SPOKE_SINE, n);
+  real *spokeModule = getRingField(ring, RingField::SPOKE_MODULE, n);
+  real *edgeCosine  = getRingField(ring, RingField::EDGE_COSINE, n);
+  real *edgeSine    = getRingField(ring, RingField::EDGE_SINE, n);
+  real *edgeModule  = getRingField(ring, RingField::EDGE_MODULE, n);
+
+  for (mini_int i = 1u; i < n; ++i)
+    setRingDistance(x[0u] - x[i], y[0u] - y[i], spokeCosine[i], spokeSine[i],
+                    spokeModule[i]);
+  for (mini_int i = 1u; i < n; ++i) {
+    const mini_int next = i + 1u < n ? i + 1u : 1u;
+    setRingDistance(x[next] - x[i], y[next] - y[i], edgeCosine[i],
+                    edgeSine[i], edgeModule[i]);
+  }
+
+  return;
+}
+
+// Force law on every spoke, or the infinite force inside the core.
+template<mini_int N>
+static void
+    setRadialForces(std::vector<real> &ring, const ForceLaw law,
+                    const real req) {
+  const mini_int n = N != 0u ? N : parameters().MINIBOIDS_PER_SUPERBOID;
+  const real *spokeCosine = getRingField(ring, RingField::SPOKE_COSINE, n);
+  const real *spokeSine   = getRingField(ring, RingField::SPOKE_SINE, n);
+  const real *spokeModule = getRingField(ring, RingField::SPOKE_MODULE, n);
+  const real *beta        = getRingField(ring, RingField::RADIAL_BETA, n);
+  real *forceX = getRingField(ring, RingField::RADIAL_FORCE_X, n);
+  real *forceY = getRingField(ring, RingField::RADIAL_FORCE_Y, n);
+
+  const real CORE     = parameters().CORE_DIAMETER;
+  const real INFINITE = parameters().INFINITE_FORCE;
+  for (mini_int i = 1u; i < n; ++i) {
+    const real scalar = getFiniteForce(law, spokeModule[i], beta[i], req);
+    const bool core   = spokeModule[i] <= CORE;
+    forceX[i] = core ? INFINITE * spokeCosine[i] : spokeCosine[i] * scalar;
+    forceY[i] = core ? INFINITE * spokeSine[i] : spokeSine[i] * scalar;
+  }
+
+  return;
+}
+
+// Angle between the spokes of the two ends of every edge.
+template<mini_int N>
+static void
+    setEdgeAngles(std::vector<real> &ring) {
+  const mini_int n = N != 0u ? N : parameters().MINIBOIDS_PER_SUPERBOID;
+  const real *spokeCosine = getRingField(ring, RingField::SPOKE_COSINE, n);
+  const real *spokeSine   = getRingField(ring, RingField::SPOKE_SINE, n);
+  real *angle             = getRingField(ring, RingField::EDGE_ANGLE, n);
+
+  for (mini_int i = 1u; i < n; ++i) {
+    const mini_int next = i + 1u < n ? i + 1u : 1u;
+    angle[i] = angleBetween(spokeCosine[i], spokeSine[i], spokeCosine[next],
+                            spokeSine[next]);
+  }
+
+  return;
+}
+
+// Kernels specialized for the usual MINIBOIDS_PER_SUPERBOID.
+#define RING_KERNEL(kernel, ...)                         \
+  switch (parameters().MINIBOIDS_PER_SUPERBOID) {        \
+    case 12u:                                            \
+      kernel<12u>(__VA_ARGS__);                          \
+      break;                                             \
+    case 19u:                                            \
+      kernel<19u>(__VA_ARGS__);                          \
+      break;                                             \
+    case 25u:                                            \
+      kernel<25u>(__VA_ARGS__);                          \
+      break;                                             \
+    default:                                             \
+      kernel<0u>(__VA_ARGS__);                           \
+  }
 
 std::ostream &
     operator<<(std::ostream &os, const Superboid &super) {
@@ -52,10 +170,7 @@ static std::vector<super_int>
 
 static type_int
     getType(const super_int id) {
-  static std::default_random_engine defaultEngine(std::time(NULL));
-  static std::mt19937 mtEngine(defaultEngine());
-  static std::uniform_int_distribution<super_int> uni(
-      0, parameters().SUPERBOIDS - 1);
+  static uint64_t draws = 0u;
 
   static auto amounts = getVectorWithNoOfSuperboidsPerType();
   static std::vector<bool> alreadySet(parameters().SUPERBOIDS, false);
@@ -67,7 +182,9 @@ static type_int
     for (type_int t = 0; t < parameters().TYPES_NO; ++t) {
       super_int supersWithTypeT = 0;
       while (supersWithTypeT < amounts[t]) {
-        super_int chosen = uni(mtEngine);
+        const RandomWords words
+            = getRandomWords(RandomStream::INITIAL_TYPE, draws++, 0u);
+        super_int chosen = getIndex(words[0u], parameters().SUPERBOIDS);
         if (alreadySet[chosen] == false) {
           alreadySet[chosen] = true;
           ++supersWithTypeT;
@@ -82,13 +199,11 @@ static type_int
 
 // Get a peripheral miniboid position considering the central miniboid
 // position is its origin.
-static std::valarray<real>
+static Vec2
     getPeripheralMiniboidPosition(const type_int TYPE, const real ANGLE) {
   const real distance = parameters().RADIAL_REQ[TYPE] * 0.5f;
 
-  std::valarray<real> position(parameters().DIMENSIONS);
-  position[X] = distance * std::cos(ANGLE);
-  position[Y] = distance * std::sin(ANGLE);
+  const Vec2 position(distance * std::cos(ANGLE), distance * std::sin(ANGLE));
   //// position += initialNoise(parameters().CORE_DIAMETER / 10.0f);
 
   return position;
@@ -111,10 +226,23 @@ Superboid::Superboid(void)
     , meanRadius2(-0.0f)
     , virtualsInfo(std::ios_base::out)
     , _deathState(DeathState::WillDie)
-    , _randomEngine(getSeed(ID))
-    , _lastDivisionStep(0) {
+    , _draws(0u)
+    , _lastDivisionStep(0)
+    , _neighborsNo(0u)
+    , _virtualsNo(0u)
+    , _virtualsThread(0u)
+    , _virtualsBegin(0u)
+    , _virtualsEnd(0u)
+    , _verletDisplacement(-0.0f)
+    , _boundingRadius(-0.0f)
+    , _boundingHitsNo(0u)
+    , _boundingRejectsNo(0u)
+    , _ring(static_cast<std::size_t>(RingField::FIELDS_NO)
+                * parameters().MINIBOIDS_PER_SUPERBOID,
+            -0.0f)
+    , _ringSet(false) {
   this->miniboids.reserve(parameters().MINIBOIDS_PER_SUPERBOID);
-  this->virtualMiniboids.reserve(64u * parameters().MINIBOIDS_PER_SUPERBOID);
+  this->segments.reserve(parameters().MINIBOIDS_PER_SUPERBOID);
 
   if (this->_totalSuperboids >= parameters().SUPERBOIDS) {
     for (mini_int miniCount = 0u;
@@ -154,7 +282,7 @@ Superboid::Superboid(void)
           std::exit(41);
         }
         this->miniboids.emplace_back(0u, *this);
-        std::valarray<real> &centralPosition = this->miniboids[0u].position;
+        ParticleVector &centralPosition = this->miniboids[0u].position;
         const super_int COLUMN
             = static_cast<super_int>(positionCount / AMOUNT_IN_A_COLUMN);
         const super_int ROW
@@ -193,8 +321,35 @@ Superboid::Superboid(void)
 
 real
     Superboid::get0to2piRandom(void) {
-  static std::uniform_real_distribution<real> uniDistribution(0.0f, TWO_PI);
-  return uniDistribution(this->_randomEngine);
+  const RandomWords words
+      = getRandomWords(RandomStream::SUPERBOID, this->_draws++, this->ID);
+  return TWO_PI * getUniform(words[0u]);
+}
+
+void
+    Superboid::setNoises(const step_int STEP) {
+  const std::size_t first = Miniboid::getParticleID(*this, 0u);
+  const mini_int n        = parameters().MINIBOIDS_PER_SUPERBOID;
+  real *noiseX = Particles::get(ParticleField::NOISE_SUM, X) + first;
+  real *noiseY = Particles::get(ParticleField::NOISE_SUM, Y) + first;
+
+  // Four angles per draw, kept in noiseX until turned into directions.
+  for (mini_int block = 0u; 4u * block < n; ++block) {
+    const RandomWords words = getRandomWords(
+        RandomStream::NOISE, STEP,
+        (static_cast<uint64_t>(this->ID) << 16) | block);
+    for (mini_int k = 0u; k < 4u && 4u * block + k < n; ++k)
+      noiseX[4u * block + k] = TWO_PI * getUniform(words[k]);
+  }
+
+  const real ETA = parameters().ETA;
+  for (mini_int i = 0u; i < n; ++i) {
+    const real angle = noiseX[i];
+    noiseX[i]        = ETA * std::cos(angle);
+    noiseY[i]        = ETA * std::sin(angle);
+  }
+
+  return;
 }
 
 void
@@ -202,7 +357,7 @@ void
   super_int sameTypeNeighborsNo    = 0u;
   super_int anotherTypeNeighborsNo = 0u;
 
-  for (const auto &superNeighborID : this->cellNeighbors()) {
+  for (const auto &superNeighborID : this->cellNeighbors) {
     if (this->type == superboids[superNeighborID].type)
       ++sameTypeNeighborsNo;
     else
@@ -234,6 +389,12 @@ void
   this->meanRadius  = -0.0f;
   this->meanRadius2 = -0.0f;
 
+  // Positions changed since the last reset.
+  if (!this->_ringSet)
+    this->setRing();
+  const real *edgeModule = getRingField(this->_ring, RingField::EDGE_MODULE,
+                                        parameters().MINIBOIDS_PER_SUPERBOID);
+
   for (const auto &mini1 : this->miniboids) {
     if (mini1.ID == 0u)
       // If central miniboid, then continue loop in the next miniboid.
@@ -241,15 +402,15 @@ void
     else if (mini1.ID
              == parameters().MINIBOIDS_PER_SUPERBOID - 1u)  // Last miniboid.
     {
-      this->perimeter += Distance(mini1, this->miniboids[1u]).module;
+      this->perimeter += edgeModule[mini1.ID];
       this->area += mini1.getAreaBetween(this->miniboids[1u]);
     } else  // Another peripheral but the last.
     {
-      this->perimeter += Distance(mini1, this->miniboids[mini1.ID + 1u]).module;
+      this->perimeter += edgeModule[mini1.ID];
       this->area += mini1.getAreaBetween(this->miniboids[mini1.ID + 1u]);
     }
 
-    real radialDistanceModule = Distance(mini1, this->miniboids[0]).module;
+    real radialDistanceModule = mini1.radialDistance.module;
     this->meanRadius += radialDistanceModule;
     this->meanRadius2 += square(radialDistanceModule);
   }
@@ -258,7 +419,105 @@ void
 }
 
 void
-    Superboid::checkVirtual(const bool export_, const step_int step) {
+    Superboid::setRing(void) {
+  const mini_int n        = parameters().MINIBOIDS_PER_SUPERBOID;
+  const std::size_t first = Miniboid::getParticleID(*this, 0u);
+  const real *x = Particles::get(ParticleField::POSITION, X) + first;
+  const real *y = Particles::get(ParticleField::POSITION, Y) + first;
+  RING_KERNEL(setRingGeometry, x, y, this->_ring);
+
+  std::vector<real> &ring = this->_ring;
+  const real *spokeCosine = getRingField(ring, RingField::SPOKE_COSINE, n);
+  const real *spokeSine   = getRingField(ring, RingField::SPOKE_SINE, n);
+  const real *spokeModule = getRingField(ring, RingField::SPOKE_MODULE, n);
+  const real *edgeCosine  = getRingField(ring, RingField::EDGE_COSINE, n);
+  const real *edgeSine    = getRingField(ring, RingField::EDGE_SINE, n);
+  const real *edgeModule  = getRingField(ring, RingField::EDGE_MODULE, n);
+  for (mini_int i = 1u; i < n; ++i) {
+    Miniboid &mini             = this->miniboids[i];
+    mini.radialDistance.module = spokeModule[i];
+    mini.radialDistance.cosine = spokeCosine[i];
+    mini.radialDistance.sine   = spokeSine[i];
+    const mini_int next        = i + 1u < n ? i + 1u : 1u;
+    for (auto &tn : mini._twistNeighbors) {
+      // Otherwise the previous one, whose edge ends here.
+      const mini_int edge = tn.ID == next ? i : tn.ID;
+      const real side     = tn.ID == next ? 1.0f : -1.0f;
+      tn._distance.module = edgeModule[edge];
+      tn._distance.cosine = side * edgeCosine[edge];
+      tn._distance.sine   = side * edgeSine[edge];
+    }
+  }
+  this->_ringSet = true;
+
+  return;
+}
+
+void
+    Superboid::addRingForces(const step_int STEP) {
+  const mini_int n        = parameters().MINIBOIDS_PER_SUPERBOID;
+  const std::size_t first = Miniboid::getParticleID(*this, 0u);
+  real *forceX = Particles::get(ParticleField::FORCE_SUM, X) + first;
+  real *forceY = Particles::get(ParticleField::FORCE_SUM, Y) + first;
+
+  // Radial, once per spoke for both ends:
+  real *beta = getRingField(this->_ring, RingField::RADIAL_BETA, n);
+  for (mini_int i = 1u; i < n; ++i)
+    beta[i] = this->miniboids[i].radialBeta();
+  RING_KERNEL(setRadialForces, this->_ring,
+              parameters().getForceLaw(ForceKind::RADIAL, this->type),
+              this->getRadialReq(STEP));
+  const real *radialX = getRingField(this->_ring, RingField::RADIAL_FORCE_X, n);
+  const real *radialY = getRingField(this->_ring, RingField::RADIAL_FORCE_Y, n);
+  for (mini_int i = 1u; i < n; ++i) {
+    forceX[0u] += radialX[i];
+    forceY[0u] += radialY[i];
+  }
+  for (mini_int i = 1u; i < n; ++i) {
+    forceX[i] += -radialX[i];
+    forceY[i] += -radialY[i];
+  }
+
+  // Twist, once per edge for the angle:
+  RING_KERNEL(setEdgeAngles, this->_ring);
+  const real *angle = getRingField(this->_ring, RingField::EDGE_ANGLE, n);
+  const type_int MY_TYPE = this->type;
+  const real req         = this->getTangentReq(STEP);
+  const ForceLaw &law
+      = parameters().getForceLaw(ForceKind::TANGENT, MY_TYPE);
+  for (mini_int i = 1u; i < n; ++i) {
+    const Miniboid &mini = this->miniboids[i];
+    const Vec2 tangent   = mini.radialDistance.getTangentArray();
+    const mini_int next  = i + 1u < n ? i + 1u : 1u;
+    for (const auto &tn : mini._twistNeighbors) {
+      const short int signal       = sign(tn.ANGLES[0u]);
+      const Miniboid &miniNeighbor = this->miniboids[tn.ID];
+      if (tn._distance.module <= parameters().CORE_DIAMETER) {
+        const Vec2 f = signal * parameters().INFINITE_FORCE * tangent;
+        forceX[i] += f[X];
+        forceY[i] += f[Y];
+      } else {
+        const real ANGLE_BETWEEN = tn.ID == next ? angle[i] : -angle[tn.ID];
+        const real SUBTRACTION = assertAngle(ANGLE_BETWEEN - tn.ANGLES[0u]);
+        const real kapa = (mini.kapa() + miniNeighbor.kapa()) / 2.0f;
+        const Vec2 f1
+            = -kapa * SUBTRACTION * parameters().RADIAL_REQ[MY_TYPE] * tangent;
+        const Vec2 f2 = -getFiniteForce(law, tn._distance.module,
+                                        mini.tangentBeta(), req)
+                        * tn._distance.getDirectionArray();
+        forceX[i] += f1[X];
+        forceY[i] += f1[Y];
+        forceX[i] += f2[X];
+        forceY[i] += f2[Y];
+      }
+    }
+  }
+
+  return;
+}
+
+real
+    Superboid::getMaxGap(const Miniboid &mini) const {
   const real _maxDistance
       = 2.0f * parameters().RADIAL_REQ[this->type]
         * std::sqrt(
@@ -266,38 +525,98 @@ void
               * (1.0f
                  - std::cos(2.0 * PI
                             / (parameters().MINIBOIDS_PER_SUPERBOID - 1u))));
+  real maxDistance = _maxDistance;
+  for (auto &tn : mini._twistNeighbors)
+    if (tn._distance.module > parameters().CORE_DIAMETER
+        && tn._distance.module < maxDistance)
+      maxDistance = tn._distance.module;
+
+  return maxDistance;
+}
+
+void
+    Superboid::checkVirtual(const thread_int THREAD_ID, const bool export_,
+                            const step_int step) {
+  std::vector<VirtualMiniboid> &pool = _virtualPools[THREAD_ID];
+  this->_virtualsThread              = THREAD_ID;
+  this->_virtualsBegin               = pool.size();
+
   if (export_)
     this->virtualsInfo.str(std::string(""));
   for (auto &mini1 : this->miniboids) {
     if (mini1.ID == 0u)
       continue;
-    std::vector<real> vec;
-    for (auto &tn : mini1._twistNeighbors)
-      if (tn._distance.module > parameters().CORE_DIAMETER)
-        vec.emplace_back(tn._distance.module);
-    vec.emplace_back(_maxDistance);
-    std::sort(vec.begin(), vec.end());
-    const real maxDistance = vec.front();
+    const real maxDistance = this->getMaxGap(mini1);
     const Distance &dist   = mini1._twistNeighbors.front()._distance;
 
     if (dist.module > maxDistance) {
       const mini_int VIRTUAL_NO
           = static_cast<mini_int>(std::floor(dist.module / maxDistance));
       for (mini_int virtID = 0; virtID < VIRTUAL_NO; ++virtID) {
-        const mini_int newID = this->virtualMiniboids.size();
-        this->virtualMiniboids.emplace_back(newID, *this, true);
-        Miniboid &virtualMini                = this->virtualMiniboids[newID];
-        std::valarray<real> differenceVector = dist.getDirectionArray();
+        Vec2 differenceVector = dist.getDirectionArray();
         differenceVector *= (virtID + 1u) * (dist.module / (VIRTUAL_NO + 1));
-        virtualMini.position = mini1.position + differenceVector;
+        const mini_int newID = pool.size() - this->_virtualsBegin;
+        VirtualMiniboid virtualMini{mini1.position + differenceVector, this,
+                                    nullptr, newID};
         if (export_)
           this->virtualsInfo << virtualMini.position << '\t' << this->type
                              << std::endl;
         virtualMini.checkLimits(step);
-        virtualMini.reset();
+        pool.push_back(virtualMini);
       }
     }
   }
+  this->_virtualsEnd = pool.size();
+
+  return;
+}
+
+void
+    Superboid::checkSegments(void) {
+  this->segments.clear();
+  for (const auto &mini1 : this->miniboids) {
+    if (mini1.ID == 0u)
+      continue;
+    const TwistNeighbor &tn = mini1._twistNeighbors.front();
+    if (tn._distance.module > this->getMaxGap(mini1))
+      this->segments.push_back(
+          MembraneSegment{&mini1, &this->miniboids[tn.ID], {0u, 0u}, {0u, 0u}});
+  }
+
+  return;
+}
+
+void
+    Superboid::setNextVelocity(const step_int STEP) {
+  this->setNoises(STEP);
+  // Miniboids read the Harris parameters of each other.
+  for (auto &mini : this->miniboids)
+    mini.setHarrisParameters();
+  for (auto &mini : this->miniboids)
+    mini.setNextVelocity(STEP);
+  this->addRingForces(STEP);
+
+  // newVelocity = SPEED * sum / |sum|, sum = noise + velocity + force sums.
+  const std::size_t first = Miniboid::getParticleID(*this, 0u);
+  const mini_int n        = parameters().MINIBOIDS_PER_SUPERBOID;
+  const real speed        = parameters().SPEED[this->type];
+  const real *noiseX = Particles::get(ParticleField::NOISE_SUM, X) + first;
+  const real *noiseY = Particles::get(ParticleField::NOISE_SUM, Y) + first;
+  const real *alphaX = Particles::get(ParticleField::VELOCITY_SUM, X) + first;
+  const real *alphaY = Particles::get(ParticleField::VELOCITY_SUM, Y) + first;
+  const real *betaX  = Particles::get(ParticleField::FORCE_SUM, X) + first;
+  const real *betaY  = Particles::get(ParticleField::FORCE_SUM, Y) + first;
+  real *newX         = Particles::get(ParticleField::NEW_VELOCITY, X) + first;
+  real *newY         = Particles::get(ParticleField::NEW_VELOCITY, Y) + first;
+  for (mini_int i = 0u; i < n; ++i) {
+    const real sumX   = noiseX[i] + alphaX[i] + betaX[i];
+    const real sumY   = noiseY[i] + alphaY[i] + betaY[i];
+    const real module = std::sqrt(square(sumX) + square(sumY));
+    if (module > 1.0e-6f) {
+      newX[i] = (speed / module) * sumX;
+      newY[i] = (speed / module) * sumY;
+    }
+  }
 
   return;
 }
@@ -306,17 +625,33 @@ void
     Superboid::setNextPosition(const step_int step) {
   this->setShape(step);
 
+  // velocity = newVelocity; position += DT * velocity.
+  const std::size_t first = Miniboid::getParticleID(*this, 0u);
+  const mini_int n        = parameters().MINIBOIDS_PER_SUPERBOID;
+  const real dt           = parameters().DT;
+  for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim) {
+    const real *newVelocity
+        = Particles::get(ParticleField::NEW_VELOCITY, dim) + first;
+    real *velocity = Particles::get(ParticleField::VELOCITY, dim) + first;
+    real *position = Particles::get(ParticleField::POSITION, dim) + first;
+    for (mini_int i = 0u; i < n; ++i) {
+      velocity[i] = newVelocity[i];
+      position[i] += dt * velocity[i];  // Velocity is already normalized.
+    }
+  }
+  this->_ringSet = false;
+
   for (auto &mini : this->miniboids)
-    mini.setNextPosition(step);
+    mini.checkLimits(step);
 
   this->miniboids[0].checkFatOut();
 
   return;
 }
 
-static std::vector<std::valarray<real>>
+static std::vector<Vec2>
     getOriginalPositions(const std::vector<Miniboid> &miniboids) {
-  std::vector<std::valarray<real>> v;
+  std::vector<Vec2> v;
   v.reserve(miniboids.size());
 
   for (const auto &mini : miniboids)
@@ -327,7 +662,7 @@ static std::vector<std::valarray<real>>
 
 static void
     setOriginalPositions(std::vector<Miniboid> &miniboids,
-                         const std::vector<std::valarray<real>> &original) {
+                         const std::vector<Vec2> &original) {
   for (auto &mini : miniboids)
     mini.position = original[mini.ID];
 
@@ -344,7 +679,7 @@ static void
        ++miniID) {
     const real angle
         = miniID * TWO_PI / (parameters().MINIBOIDS_PER_SUPERBOID - 1);
-    std::valarray<real> dist({std::cos(angle), std::sin(angle)});
+    Vec2 dist(std::cos(angle), std::sin(angle));
     dist *= distance + parameters().REAL_TOLERANCE;
     superboid.miniboids[miniID].position
         = superboid.miniboids[0u].position + dist;
@@ -357,7 +692,8 @@ static void
 
 bool
     Superboid::divide(const super_int divide_by, Superboid &newSuperboid,
-                      std::vector<Box> &boxes, const step_int step) {
+                      std::vector<Box> &boxes,
+                      std::vector<Superboid> &superboids, const step_int step) {
   if (divide_by < 2u) {
     std::cerr << "Cannot divide by n | n < 2" << std::endl;
     return false;
@@ -367,14 +703,13 @@ bool
     return false;
   }
 
-  static std::random_device devRand;
-  static std::default_random_engine generator(devRand());
-  std::uniform_int_distribution<int> distribution(0, parameters().TYPES_NO - 1);
-  const type_int newType = distribution(generator);
+  const RandomWords words
+      = getRandomWords(RandomStream::DIVISION_TYPE, step, this->ID);
+  const type_int newType = getIndex(words[0u], parameters().TYPES_NO);
 
   *const_cast<type_int *>(&(newSuperboid.type)) = newType;
 
-  const std::vector<std::valarray<real>> originalPositions
+  const std::vector<Vec2> originalPositions
       = getOriginalPositions(this->miniboids);
   newSuperboid.activate();
   newSuperboid.clearVirtualMiniboids();
@@ -386,10 +721,6 @@ bool
     newSuperboid.miniboids[miniID].velocity = this->miniboids[miniID].velocity;
     newSuperboid.miniboids[miniID].newVelocity
         = this->miniboids[miniID].newVelocity;
-
-    const box_int newBoxID
-        = Box::getBoxID(newSuperboid.miniboids[miniID].position);
-    boxes[newBoxID].append(newSuperboid.miniboids[miniID]);
   }
 
   step_int atempts = 0;
@@ -398,7 +729,7 @@ bool
     setOriginalPositions(this->miniboids, originalPositions);
 
     if (atempts > 6) {
-      nextBoxes(boxes, *this, step);
+      nextBoxes(boxes, superboids, *this, step);
 
       newSuperboid.setDeactivation(
           "newSuperboid could not be child cell (division)");
@@ -409,8 +740,8 @@ bool
     bool someInvasion = false;
 
     real divisionAngle = this->get0to2piRandom();
-    std::valarray<real> nucleusNucleusDistance(
-        {std::cos(divisionAngle), std::sin(divisionAngle)});
+    Vec2 nucleusNucleusDistance(std::cos(divisionAngle),
+                                std::sin(divisionAngle));
     nucleusNucleusDistance *= parameters().DIVISION_DISTANCE;
 
     newSuperboid.miniboids[0u].position
@@ -431,7 +762,7 @@ bool
       if (insideBox)
         for (const auto &mini : superPtr->miniboids)
           if (insideBox)
-            for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim) {
+            for (dimension_int dim = 0u; dim < Vec2::DIMENSIONS; ++dim) {
               const real HALF_RECTANGLE_SIZE
                   = 0.5f * parameters().RECTANGLE_SIZE[dim];
               if (std::abs(mini.position[dim]) > HALF_RECTANGLE_SIZE)
@@ -440,16 +771,13 @@ bool
     if (insideBox == false)
       continue;
 
-    for (auto &mini : newSuperboid.miniboids)
-      mini.setBox(&boxes[Box::getBoxID(mini.position)]);
-
-    nextBoxes(boxes, *this, step);
+    nextBoxes(boxes, superboids, *this, step);
 
+    for (auto super : twoSupers)
+      super->setGeometry();
     for (auto super : twoSupers) {
       for (auto &mini : super->miniboids)
         mini.setNeighbors(step);
-      for (auto &mini : super->virtualMiniboids)
-        mini.setNeighbors(step);
     }
 
     for (auto super : twoSupers) {
@@ -462,8 +790,8 @@ bool
             }
 
         if (!someInvasion) {
-          for (const auto &pair : mini._neighbors)
-            if (mini.fatInteractions(0, std::get<1>(pair), false)) {
+          for (const auto &cell : mini._neighbors)
+            if (mini.fatInteractions(0, cell, false)) {
               someInvasion = true;
               break;
             }
@@ -523,8 +851,7 @@ Distance
 
 void
     Superboid::checkWrongNeighbors(const std::vector<Superboid> &superboids) {
-  const std::list<super_int> neighbors
-      = this->cellNeighbors();  // Value, not referece.
+  const CellNeighbors neighbors = this->cellNeighbors;  // Value, not referece.
   for (const auto cellID1 : neighbors) {
     for (const auto cellID2 : neighbors) {
       if (cellID1 == cellID2)
@@ -544,22 +871,14 @@ void
         const Distance halfDist = dist * portion;
 
         //// checar BC periódica depois!!!!!!!!!!!!!!!!!!!!
-        if (isPointInSomeNthTriangle(
-                1,
+        if (super1.nucleusFan(1u).contains(
                 this->miniboids[0u].position
-                    + (halfDist.getDirectionArray() * halfDist.module),
-                super1)) {
+                + halfDist.getDirectionArray() * halfDist.module)) {
           this->cellNeighbors.remove(cellID2);
           for (auto &mini : this->miniboids)
-            for (auto &pair : mini._neighbors) {
-              auto &cell = std::get<1>(pair);
-              if (!cell.empty()) {
-                const super_int superID
-                    = cell.front().miniNeighbor.superboid.ID;
-                if (superID == super2.ID)
-                  cell.clear();
-              }
-            }
+            for (auto &cell : mini._neighbors)
+              if (cell.superID == super2.ID)
+                cell.clear();
           break;
         }
       }
@@ -573,14 +892,17 @@ void
     std::cerr << "death " << this->ID << ": " << this->_deathMessage
               << std::endl;
 
-  for (auto &mini : this->miniboids) {
-    if (mini.getBoxPtr())
-      mini.getBoxPtr()->remove(mini);
+  // Its miniboids leave the boxes on the next Box::fill.
+  for (auto &mini : this->miniboids)
     mini.setBox(nullptr);
-  }
 
   this->_deathState = DeathState::Dead;
 
+  const auto it
+      = std::lower_bound(_activated.begin(), _activated.end(), this->ID);
+  if (it != _activated.end() && *it == this->ID)
+    _activated.erase(it);
+
   return;
 }
 
@@ -588,16 +910,40 @@ void
     Superboid::activate(void) {
   this->_deathState = DeathState::Live;
 
+  const auto it
+      = std::lower_bound(_activated.begin(), _activated.end(), this->ID);
+  if (it == _activated.end() || *it != this->ID)
+    _activated.insert(it, this->ID);
+
   return;
 }
 
+super_int
+    Superboid::getFreeID(void) {
+  super_int freeID = 0u;
+  for (const auto superID : _activated) {
+    if (superID != freeID)
+      break;
+    ++freeID;
+  }
+
+  return freeID;
+}
+
 void
     Superboid::clearVirtualMiniboids(void) {
-  for (auto &mini : this->virtualMiniboids) {
-    if (mini.getBoxPtr())
-      mini.getBoxPtr()->remove(mini);
-  }
-  this->virtualMiniboids.clear();
+  this->_virtualsBegin = 0u;
+  this->_virtualsEnd   = 0u;
+  this->segments.clear();
+
+  return;
+}
+
+void
+    Superboid::clearVirtualPools(const thread_int threadsNo) {
+  _virtualPools.resize(threadsNo);
+  for (auto &pool : _virtualPools)
+    pool.clear();
 
   return;
 }
@@ -628,6 +974,122 @@ void
   return;
 }
 
+void
+    Superboid::setWorkload(void) {
+  this->_neighborsNo = 0u;
+  for (const auto &mini : this->miniboids)
+    for (const auto &cell : mini._neighbors)
+      this->_neighborsNo += cell.count;
+  this->_virtualsNo
+      = this->_virtualsEnd - this->_virtualsBegin + this->segments.size();
+
+  return;
+}
+
+void
+    Superboid::setVerletDisplacement(void) {
+  this->_verletDisplacement = -0.0f;
+  for (const auto &mini : this->miniboids) {
+    const real displacement = mini.getVerletDisplacement();
+    if (displacement > this->_verletDisplacement)
+      this->_verletDisplacement = displacement;
+  }
+
+  return;
+}
+
+void
+    Superboid::setGeometry(void) {
+  const Vec2 nucleus(this->miniboids[0u].position);
+  real radius2 = -0.0f;
+  for (const auto &mini : this->miniboids) {
+    const Vec2 delta = mini.position - nucleus;
+    radius2 = std::max(radius2, delta[X] * delta[X] + delta[Y] * delta[Y]);
+  }
+  // Virtual miniboids are the ones of this step, set just before. Only when
+  // divide() calls this after the position phase are they stale.
+  for (const auto &mini : this->virtualMiniboids()) {
+    const Vec2 delta = mini.position - nucleus;
+    radius2 = std::max(radius2, delta[X] * delta[X] + delta[Y] * delta[Y]);
+  }
+  this->_boundingRadius = std::sqrt(radius2);
+
+  // Nucleus 0 is skipped as a peripheral, but may be the nth next one.
+  const mini_int PERIPHERALS = parameters().MINIBOIDS_PER_SUPERBOID - 1u;
+  for (mini_int nth = 1u; nth <= 2u; ++nth) {
+    TriangleFan &fan = this->_nucleusFans[nth - 1u];
+    fan.clear(nucleus);
+    for (mini_int miniID = 1u; miniID <= PERIPHERALS; ++miniID) {
+      const mini_int nextID = (miniID % PERIPHERALS + nth) % PERIPHERALS;
+      fan.add(this->miniboids[miniID].position,
+              this->miniboids[nextID].position, miniID, nextID);
+    }
+  }
+
+  return;
+}
+
+// Built from the positions after the move of this step, so it cannot reuse
+// the geometry set before it.
+bool
+    Superboid::isNucleusInside(void) {
+  const Vec2 nucleus(this->miniboids[0u].position);
+  this->_membraneFan.clear(Vec2(this->miniboids[1u].position));
+  for (mini_int miniID = 2u; miniID < parameters().MINIBOIDS_PER_SUPERBOID - 1u;
+       ++miniID)
+    this->_membraneFan.add(this->miniboids[miniID].position,
+                           this->miniboids[miniID + 1u].position, miniID,
+                           miniID + 1u);
+
+  return this->_membraneFan.contains(nucleus);
+}
+
+bool
+    Superboid::mayReach(const Superboid &other, const Vec2 &point,
+                        const real range) {
+  const real dx = Distance::getMinimalImage(point[X]
+                                            - other.miniboids[0u].position[X]);
+  const real dy = Distance::getMinimalImage(point[Y]
+                                            - other.miniboids[0u].position[Y]);
+  const real reach = other._boundingRadius + range;
+  if (dx * dx + dy * dy > reach * reach) {
+    ++this->_boundingRejectsNo;
+    return false;
+  }
+  ++this->_boundingHitsNo;
+
+  return true;
+}
+
+void
+    getSegmentsInReach(const Miniboid &mini, ReachFilter &inReach,
+                       std::vector<const MembraneSegment *> &segments) {
+  segments.clear();
+  for (auto box : mini.getBox().neighbors)
+    for (auto segment : box->segments())
+      if (inReach(segment->first->superboid)
+          && std::find(segments.begin(), segments.end(), segment)
+                 == segments.end())
+        segments.push_back(segment);
+
+  return;
+}
+
+void
+    Superboid::popBoundingChecks(std::vector<Superboid> &superboids,
+                                 step_int &hitsNo, step_int &rejectsNo) {
+  hitsNo    = 0u;
+  rejectsNo = 0u;
+  for (auto &superboid : superboids) {
+    hitsNo += superboid._boundingHitsNo;
+    rejectsNo += superboid._boundingRejectsNo;
+    superboid._boundingHitsNo    = 0u;
+    superboid._boundingRejectsNo = 0u;
+  }
+
+  return;
+}
+
 real
     Superboid::getRadialReq(const step_int step) const {
   if (parameters().DIVISION_INTERVAL == 0)
@@ -4,20 +4,41 @@
 
 #pragma once
 #include <iostream>  // operator<< .
-#include <random>
 #include <sstream>
-#include <valarray>
 #include <vector>
 
 #include "CellNeighbors.hpp"
 #include "Miniboid.hpp"
+#include "Slice.hpp"
+#include "TriangleFan.hpp"
 
 enum class DeathState { Live, WillDie, Dead };
 
 class Superboid {
  public:
-  std::vector<Miniboid> virtualMiniboids;
+  // Virtual miniboids set by the last checkVirtual, in the pool of the thread
+  // that ran it.
+  inline Slice<VirtualMiniboid> virtualMiniboids(void) {
+    if (this->_virtualsBegin == this->_virtualsEnd)
+      return Slice<VirtualMiniboid>(nullptr, nullptr);
+    VirtualMiniboid *pool = _virtualPools[this->_virtualsThread].data();
+    return Slice<VirtualMiniboid>(pool + this->_virtualsBegin,
+                                  pool + this->_virtualsEnd);
+  }
+  inline Slice<const VirtualMiniboid> virtualMiniboids(void) const {
+    if (this->_virtualsBegin == this->_virtualsEnd)
+      return Slice<const VirtualMiniboid>(nullptr, nullptr);
+    const VirtualMiniboid *pool = _virtualPools[this->_virtualsThread].data();
+    return Slice<const VirtualMiniboid>(pool + this->_virtualsBegin,
+                                        pool + this->_virtualsEnd);
+  }
+  // Membrane segments set by the last checkSegments. Never reallocated, the
+  // boxes point into it.
+  std::vector<MembraneSegment> segments;
+  // Also clears the membrane segments.
   void clearVirtualMiniboids(void);
+  // Forget the virtual miniboids of every superboid, keeping the memory.
+  static void clearVirtualPools(const thread_int threadsNo);
 
   std::vector<Miniboid> miniboids;
   const super_int ID;
@@ -37,23 +58,35 @@ class Superboid {
       mini.reset();
       ////mini._tangentNeighbors.clear();
     }
-    this->cellNeighbors = CellNeighbors();
+    this->setRing();
+    this->cellNeighbors.clear();
     this->infiniteVectors.clear();
     this->infinite2Vectors.clear();
     this->_deathMessage = "";
   }
+  // Spokes (radialDistance) and ring edges (twist neighbor distances) of the
+  // peripheral miniboids, each computed once for both of its ends.
+  void setRing(void);
   Superboid(void);
+  // Draws of each superboid are in the order they are taken.
   real get0to2piRandom(void);
-  void checkVirtual(const bool export_, const step_int);
+  // ETA times a random direction for every miniboid, in one batch.
+  void setNoises(const step_int);
+  void checkVirtual(const thread_int THREAD_ID, const bool export_,
+                    const step_int);
+  // Same gaps as checkVirtual, closed by segments instead.
+  void checkSegments(void);
+  void setNextVelocity(const step_int);
   void setNextPosition(const step_int);
-  bool divide(const super_int, Superboid &, std::vector<Box> &, const step_int);
+  bool divide(const super_int, Superboid &, std::vector<Box> &,
+              std::vector<Superboid> &, const step_int);
   Distance getBiggestAxis() const;
 
   CellNeighbors cellNeighbors;
   void checkWrongNeighbors(const std::vector<Superboid> &);
 
-  std::vector<std::valarray<real>> infiniteVectors;
-  std::vector<std::valarray<real>> infinite2Vectors;
+  std::vector<VecN<4u>> infiniteVectors;  // Position and direction.
+  std::vector<VecN<4u>> infinite2Vectors;
   std::ostringstream virtualsInfo;
   step_int getLastDivisionStep(void) const { return this->_lastDivisionStep; }
 
@@ -62,20 +95,120 @@ class Superboid {
   void deactivate(void);
   bool isActivated(void) const;
   void activate(void);  // Ignoring boxes.
+  // IDs of the activated cells, in increasing order. Kept up to date by
+  // activate and deactivate, so loops cost the live cells, not
+  // MAX_SUPERBOIDS.
+  static inline const std::vector<super_int> &activated(void) {
+    return _activated;
+  }
+  static super_int getFreeID(void);  // Lowest deactivated ID.
   void checkBackInTime(const step_int);
   real getRadialReq(const step_int) const;
   real getTangentReq(const step_int) const;
 
+  // Cost estimate used to balance threads: particles plus particle neighbors
+  // and virtual particles found in the last neighbor search.
+  void setWorkload(void);
+  inline step_int workload(void) const {
+    return this->miniboids.size() + this->_neighborsNo + this->_virtualsNo;
+  }
+  // Biggest miniboid displacement since the Verlet candidates were set.
+  void setVerletDisplacement(void);
+  inline real verletDisplacement(void) const {
+    return this->_verletDisplacement;
+  }
+  // Geometry kept for the rest of the step: the bounding circle and the
+  // nucleus fans. Set again whenever positions change.
+  void setGeometry(void);
+  // Triangles (nucleus, miniboid, nth next miniboid along the membrane) of
+  // every peripheral miniboid, for nth 1 or 2.
+  inline const TriangleFan &nucleusFan(const mini_int nth) const {
+    return this->_nucleusFans[nth - 1u];
+  }
+  // Whether the nucleus is inside the fan around miniboid 1, from the
+  // current positions.
+  bool isNucleusInside(void);
+  // False if nothing of other is within range of point. Counted in the
+  // bounding checks of this superboid.
+  bool mayReach(const Superboid &other, const Vec2 &point, const real range);
+  // Bounding checks that passed and that rejected a cell, summed over the
+  // superboids since the last call. The half-shell search of the boxes does
+  // none.
+  static void popBoundingChecks(std::vector<Superboid> &, step_int &hitsNo,
+                                step_int &rejectsNo);
+
  protected:
   static super_int _totalSuperboids;
+  static std::vector<super_int> _activated;
+  // [thread]: virtual miniboids set by the thread in this step.
+  static std::vector<std::vector<VirtualMiniboid>> _virtualPools;
   std::string _deathMessage;
   DeathState _deathState;
-  std::default_random_engine _randomEngine;
+  uint64_t _draws;  // Of get0to2piRandom, its counter.
   step_int _shapeStep;
   step_int _lastDivisionStep;
+  step_int _neighborsNo;
+  step_int _virtualsNo;
+  thread_int _virtualsThread;
+  std::size_t _virtualsBegin;
+  std::size_t _virtualsEnd;
+  real _verletDisplacement;
+  // Bounding circle: centered at the nucleus, with the largest distance from
+  // it to a miniboid, so it holds the fan, the virtual miniboids and the
+  // membrane segments too. Plain differences are used, so a cell split by
+  // the periodic limits gets a circle too big to reject anything.
+  real _boundingRadius;
+  TriangleFan _nucleusFans[2];
+  TriangleFan _membraneFan;  // Storage of isNucleusInside, not geometry.
+  step_int _boundingHitsNo;
+  step_int _boundingRejectsNo;
+  // Longest gap from a peripheral miniboid to its neighbor along the
+  // membrane that needs no closing.
+  real getMaxGap(const Miniboid &) const;
+  // [field * MINIBOIDS_PER_SUPERBOID + miniboid ID], see setRing.
+  std::vector<real> _ring;
+  bool _ringSet;  // False once positions change.
+  // Radial and twist forces, from the spokes and ring edges of setRing.
+  void addRingForces(const step_int);
   Superboid(Superboid &) = delete;
 };
 
+// Bounding checks of a search point against the superboids of a sequence of
+// miniboids, done once per run of miniboids of the same superboid. The own
+// superboid and deactivated ones are never in reach.
+class ReachFilter {
+ public:
+  inline ReachFilter(Superboid &searcher, const Vec2 &point, const real range)
+      : _searcher(searcher)
+      , _point(point)
+      , _range(range)
+      , _last(nullptr)
+      , _inReach(false) {
+    return;
+  }
+  inline bool operator()(const Superboid &other) {
+    if (&other != this->_last) {
+      this->_last    = &other;
+      this->_inReach = other.ID != this->_searcher.ID && other.isActivated()
+                       && this->_searcher.mayReach(other, this->_point,
+                                                   this->_range);
+    }
+    return this->_inReach;
+  }
+
+ protected:
+  Superboid &_searcher;
+  const Vec2 _point;
+  const real _range;
+  const Superboid *_last;
+  bool _inReach;
+};
+
+// Segments in the boxes around mini that are in reach, each once: a segment
+// may be in more than one of the boxes. segments is cleared first.
+void getSegmentsInReach(const Miniboid &mini, ReachFilter &inReach,
+                        std::vector<const MembraneSegment *> &segments);
+
 extern std::ostream &
     operator<<(std::ostream &os, const Superboid &super);
 
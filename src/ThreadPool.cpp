@@ -0,0 +1,151 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#include "ThreadPool.hpp"
+
+#include <sstream>
+
+ThreadPool::ThreadPool(const thread_int threadsNo)
+    : _threadsNo(threadsNo > 0u ? threadsNo : 1u)
+    , _busy(_threadsNo, -0.0f)
+    , _job(nullptr)
+    , _generation(0u)
+    , _pending(0u)
+    , _quit(false)
+    , _overhead(-0.0f)
+    , _phasesNo(0u) {
+  this->_workers.reserve(this->_threadsNo - 1u);
+  for (thread_int threadID = 1u; threadID < this->_threadsNo; ++threadID)
+    this->_workers.emplace_back(&ThreadPool::work, this, threadID);
+
+  return;
+}
+
+ThreadPool::~ThreadPool(void) {
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_quit = true;
+  }
+  this->_start.notify_all();
+  for (auto &worker : this->_workers)
+    worker.join();
+
+  return;
+}
+
+void
+    ThreadPool::runJob(const thread_int THREAD_ID) {
+  const Clock::time_point begin = Clock::now();
+  (*this->_job)(THREAD_ID);
+  this->_busy[THREAD_ID]
+      = std::chrono::duration<real>(Clock::now() - begin).count();
+
+  return;
+}
+
+void
+    ThreadPool::work(const thread_int THREAD_ID) {
+  step_int seenGeneration = 0u;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(this->_mutex);
+      this->_start.wait(lock, [&] {
+        return this->_quit || this->_generation != seenGeneration;
+      });
+      if (this->_quit)
+        return;
+      seenGeneration = this->_generation;
+    }
+
+    this->runJob(THREAD_ID);
+
+    bool last;
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      last = (--this->_pending == 0u);
+    }
+    if (last)
+      this->_finish.notify_one();
+  }
+}
+
+void
+    ThreadPool::run(const char *phase, const Job &job) {
+  const Clock::time_point begin = Clock::now();
+
+  if (this->_threadsNo > 1u) {
+    {
+      std::lock_guard<std::mutex> lock(this->_mutex);
+      this->_job     = &job;
+      this->_pending = this->_threadsNo - 1u;
+      ++this->_generation;
+    }
+    this->_start.notify_all();
+  } else
+    this->_job = &job;
+
+  this->runJob(0u);
+
+  if (this->_threadsNo > 1u) {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    this->_finish.wait(lock, [&] { return this->_pending == 0u; });
+  }
+  this->_job = nullptr;
+
+  real slowest = -0.0f;
+  real mean    = -0.0f;
+  for (const auto busy : this->_busy) {
+    mean += busy;
+    if (busy > slowest)
+      slowest = busy;
+  }
+  mean /= this->_threadsNo;
+  this->_overhead
+      += std::chrono::duration<real>(Clock::now() - begin).count() - slowest;
+  ++this->_phasesNo;
+
+  PhaseStatistics *statistics = nullptr;
+  for (auto &s : this->_statistics)
+    if (s.phase == phase) {
+      statistics = &s;
+      break;
+    }
+  if (statistics == nullptr) {
+    this->_statistics.push_back(PhaseStatistics({phase, -0.0f, -0.0f}));
+    statistics = &this->_statistics.back();
+  }
+  statistics->slowest += slowest;
+  statistics->mean += mean;
+
+  return;
+}
+
+real
+    ThreadPool::popOverhead(void) {
+  const real overhead = this->_overhead;
+  this->_overhead     = -0.0f;
+  return overhead;
+}
+
+step_int
+    ThreadPool::popPhasesNo(void) {
+  const step_int phasesNo = this->_phasesNo;
+  this->_phasesNo         = 0u;
+  return phasesNo;
+}
+
+std::string
+    ThreadPool::popImbalance(void) {
+  std::ostringstream stream;
+  stream.precision(3);
+  for (auto &statistics : this->_statistics) {
+    if (statistics.mean > 0.0f)
+      stream << std::fixed << statistics.phase << ' '
+             << statistics.slowest / statistics.mean << ' ';
+    statistics.slowest = -0.0f;
+    statistics.mean    = -0.0f;
+  }
+
+  return stream.str();
+}
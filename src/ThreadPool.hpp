@@ -0,0 +1,63 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "parameters.hpp"
+
+// Persistent workers. A phase is dispatched to every thread (the calling
+// thread works as THREAD_ID 0) and run() only returns after all of them have
+// finished it, so each call is one fork/join barrier without creating threads.
+class ThreadPool {
+ public:
+  typedef std::function<void(const thread_int)> Job;
+
+  explicit ThreadPool(const thread_int threadsNo);
+  ~ThreadPool(void);
+  void run(const char *phase, const Job &job);
+  inline thread_int size(void) const { return this->_threadsNo; }
+
+  // Wall time of the phases not spent by the slowest thread inside the job,
+  // i.e. dispatch and barrier cost, accumulated since the last call.
+  real popOverhead(void);  // Seconds.
+  step_int popPhasesNo(void);
+  // Slowest thread busy time over mean thread busy time of every phase since
+  // the last call, as "phase ratio" pairs. 1 means perfect balance.
+  std::string popImbalance(void);
+
+ protected:
+  typedef std::chrono::steady_clock Clock;
+  struct PhaseStatistics {
+    const char *phase;
+    real slowest;  // Seconds.
+    real mean;     // Seconds.
+  };
+
+  const thread_int _threadsNo;
+  std::vector<std::thread> _workers;
+  std::vector<real> _busy;  // Seconds inside the job, per thread.
+
+  std::mutex _mutex;
+  std::condition_variable _start;
+  std::condition_variable _finish;
+  const Job *_job;
+  step_int _generation;
+  thread_int _pending;
+  bool _quit;
+
+  real _overhead;
+  step_int _phasesNo;
+  std::vector<PhaseStatistics> _statistics;
+
+  void work(const thread_int THREAD_ID);
+  void runJob(const thread_int THREAD_ID);
+  ThreadPool(const ThreadPool &) = delete;
+};
@@ -0,0 +1,82 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#include "TriangleFan.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "Distance.hpp"
+
+TriangleFan::TriangleFan(void) {
+  this->clear(Vec2());
+
+  return;
+}
+
+void
+    TriangleFan::clear(const Vec2 &apex) {
+  this->_apex = apex;
+  this->_min  = Vec2(std::numeric_limits<real>::max());
+  this->_max  = Vec2(-std::numeric_limits<real>::max());
+  this->_firstX.clear();
+  this->_firstY.clear();
+  this->_secondX.clear();
+  this->_secondY.clear();
+  this->_determinants.clear();
+  this->_firstIDs.clear();
+  this->_secondIDs.clear();
+
+  return;
+}
+
+void
+    TriangleFan::add(const ParticleVector &first, const ParticleVector &second,
+                     const mini_int firstID, const mini_int secondID) {
+  const real firstX = Distance::getMinimalImage(this->_apex[X] - first[X]);
+  const real firstY = Distance::getMinimalImage(this->_apex[Y] - first[Y]);
+  const real secondX = Distance::getMinimalImage(this->_apex[X] - second[X]);
+  const real secondY = Distance::getMinimalImage(this->_apex[Y] - second[Y]);
+
+  const real determinant = (firstX * secondY) - (firstY * secondX);
+  const real sign        = determinant > 0.0f ? 1.0f : -1.0f;
+  this->_firstX.push_back(sign * firstX);
+  this->_firstY.push_back(sign * firstY);
+  this->_secondX.push_back(sign * secondX);
+  this->_secondY.push_back(sign * secondY);
+  this->_determinants.push_back(sign * determinant);
+  this->_firstIDs.push_back(firstID);
+  this->_secondIDs.push_back(secondID);
+
+  this->_min[X] = std::min({this->_min[X], 0.0f, firstX, secondX});
+  this->_min[Y] = std::min({this->_min[Y], 0.0f, firstY, secondY});
+  this->_max[X] = std::max({this->_max[X], 0.0f, firstX, secondX});
+  this->_max[Y] = std::max({this->_max[Y], 0.0f, firstY, secondY});
+
+  return;
+}
+
+std::size_t
+    TriangleFan::find(const Vec2 &point) const {
+  const std::size_t size = this->size();
+  const real dX = Distance::getMinimalImage(this->_apex[X] - point[X]);
+  const real dY = Distance::getMinimalImage(this->_apex[Y] - point[Y]);
+  if (dX < this->_min[X] || dX > this->_max[X] || dY < this->_min[Y]
+      || dY > this->_max[Y])
+    return size;
+
+  // Barycentric coordinates times the determinant.
+  std::size_t found = size;
+  for (std::size_t triangle = size; triangle-- > 0u;) {
+    const real s = (this->_secondY[triangle] * dX)
+                   - (this->_secondX[triangle] * dY);
+    const real t = (this->_firstX[triangle] * dY)
+                   - (this->_firstY[triangle] * dX);
+    const bool inside = (s >= 0.0f) & (t >= 0.0f)
+                        & (s + t <= this->_determinants[triangle]);
+    found = inside ? triangle : found;
+  }
+
+  return found;
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <vector>
+
+#include "Particles.hpp"
+#include "Vec.hpp"
+#include "parameters.hpp"
+
+// Triangles sharing an apex, set once and tested against many points. Edges
+// are taken from the apex with minimal images and kept as arrays, with the
+// sign of the barycentric denominator already applied, so a test is a few
+// products per triangle and no branch.
+class TriangleFan {
+ public:
+  TriangleFan(void);
+  // Forget the triangles, keeping the memory.
+  void clear(const Vec2 &apex);
+  // Triangle (apex, first, second); the IDs are kept for find.
+  void add(const ParticleVector &first, const ParticleVector &second,
+           const mini_int firstID, const mini_int secondID);
+  inline std::size_t size(void) const { return this->_determinants.size(); }
+  // First triangle holding point, or size() if none.
+  std::size_t find(const Vec2 &point) const;
+  inline bool contains(const Vec2 &point) const {
+    return this->find(point) < this->size();
+  }
+  inline mini_int firstID(const std::size_t triangle) const {
+    return this->_firstIDs[triangle];
+  }
+  inline mini_int secondID(const std::size_t triangle) const {
+    return this->_secondIDs[triangle];
+  }
+
+ protected:
+  Vec2 _apex;
+  // Bounding box of the triangles, as apex minus point.
+  Vec2 _min;
+  Vec2 _max;
+  // Apex minus first and apex minus second, times the sign of the
+  // determinant.
+  std::vector<real> _firstX;
+  std::vector<real> _firstY;
+  std::vector<real> _secondX;
+  std::vector<real> _secondY;
+  std::vector<real> _determinants;  // Never negative.
+  std::vector<mini_int> _firstIDs;
+  std::vector<mini_int> _secondIDs;
+};
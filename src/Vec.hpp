@@ -0,0 +1,135 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <iostream>
+#include <utility>
+
+#include "parameters.hpp"
+
+// Fixed-size vector of reals. The size is known at compile time, so vectors
+// live on the stack and every loop below is unrolled by the compiler.
+template<dimension_int N>
+class VecN {
+ public:
+  static constexpr dimension_int DIMENSIONS = N;
+
+  inline VecN(void) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] = 0.0f;
+  }
+  inline explicit VecN(const real r) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] = r;
+  }
+  template<typename... Reals>
+  inline VecN(const real first, const real second, const Reals... others)
+      : _components{first, second, static_cast<real>(others)...} {
+    static_assert(sizeof...(Reals) + 2u == N, "Wrong number of components.");
+    return;
+  }
+  // Any other vector-like type with N components (ParticleVector).
+  template<typename Array,
+           typename = decltype(std::declval<const Array &>()[0u],
+                               std::declval<const Array &>().size())>
+  inline VecN(const Array &array) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] = array[dim];
+  }
+
+  inline real &operator[](const std::size_t dim) {
+    return this->_components[dim];
+  }
+  inline const real &operator[](const std::size_t dim) const {
+    return this->_components[dim];
+  }
+  static constexpr std::size_t size(void) { return N; }
+  inline real *begin(void) { return this->_components; }
+  inline real *end(void) { return this->_components + N; }
+  inline const real *begin(void) const { return this->_components; }
+  inline const real *end(void) const { return this->_components + N; }
+
+  inline real sum(void) const {
+    real s = 0.0f;
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      s += this->_components[dim];
+    return s;
+  }
+
+  template<typename Array>
+  inline VecN &operator+=(const Array &array) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] += array[dim];
+    return *this;
+  }
+  template<typename Array>
+  inline VecN &operator-=(const Array &array) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] -= array[dim];
+    return *this;
+  }
+  inline VecN &operator+=(const real r) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] += r;
+    return *this;
+  }
+  inline VecN &operator*=(const real r) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] *= r;
+    return *this;
+  }
+  inline VecN &operator/=(const real r) {
+    for (dimension_int dim = 0u; dim < N; ++dim)
+      this->_components[dim] /= r;
+    return *this;
+  }
+
+ protected:
+  real _components[N];
+};
+
+typedef VecN<2u> Vec2;
+
+template<dimension_int N>
+inline VecN<N>
+    operator-(VecN<N> v) {
+  return v *= -1.0f;
+}
+
+template<dimension_int N>
+inline VecN<N>
+    operator+(VecN<N> v1, const VecN<N> &v2) {
+  return v1 += v2;
+}
+
+template<dimension_int N>
+inline VecN<N>
+    operator-(VecN<N> v1, const VecN<N> &v2) {
+  return v1 -= v2;
+}
+
+template<dimension_int N>
+inline VecN<N> operator*(const real r, VecN<N> v) {
+  return v *= r;
+}
+
+template<dimension_int N>
+inline VecN<N> operator*(VecN<N> v, const real r) {
+  return v *= r;
+}
+
+template<dimension_int N>
+inline VecN<N>
+    operator/(VecN<N> v, const real r) {
+  return v /= r;
+}
+
+template<dimension_int N>
+inline std::ostream &
+    operator<<(std::ostream &os, const VecN<N> &v) {
+  for (const auto &component : v)
+    os << std::fixed << component << '\t';
+
+  return os;
+}
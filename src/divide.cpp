@@ -6,6 +6,8 @@
 
 #include <set>
 
+#include "random.hpp"
+
 void
     divide(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
            const step_int step) {
@@ -15,9 +17,8 @@ void
 
   std::set<super_int> eligibleCells;
 
-  for (const auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    const Superboid &super = superboids[superID];
     if (super.getLastDivisionStep() + parameters().NON_DIVISION_INTERVAL
         <= nonDivisionInterval) {
       if (super.miniboids[0].position[X] < parameters().DIVISION_REGION_X)
@@ -25,6 +26,11 @@ void
     }
   }
 
+  // Positions changed since the geometry was set.
+  if (eligibleCells.size() > 0)
+    for (const auto superID : Superboid::activated())
+      superboids[superID].setGeometry();
+
   step_int atempts = 0;
   while (true) {
     ++atempts;
@@ -35,12 +41,9 @@ void
     if (eligibleCells.size() == 0)
       return;
 
-    static std::random_device deviceEngine;
-    static std::default_random_engine generator(deviceEngine());
-    std::uniform_int_distribution<int> distribution(0,
-                                                    eligibleCells.size() - 1);
-
-    const super_int chosenOrd = distribution(generator);
+    const RandomWords words
+        = getRandomWords(RandomStream::DIVISION_CELL, step, atempts);
+    const super_int chosenOrd = getIndex(words[0u], eligibleCells.size());
     super_int chosenCount     = 0;
     super_int chosen          = 42424;
     for (const auto superID : eligibleCells) {
@@ -59,13 +62,13 @@ void
       continue;
     }
 
-    for (auto &super : superboids)
-      if (super.isActivated() == false) {
-        if (superboids[chosen].divide(2, super, boxes, step) == true)
-          return;
-        else
-          break;
-      }
+    const super_int freeID = Superboid::getFreeID();
+    if (freeID < superboids.size()) {
+      if (superboids[chosen].divide(2, superboids[freeID], boxes,
+                                   superboids, step)
+          == true)
+        return;
+    }
   }
 
   return;
@@ -4,13 +4,15 @@
 
 #pragma once
 
-#include <valarray>
-
-#include "Distance.hpp"
 #include "parameters.hpp"
 
-std::valarray<real>
-    getFiniteForce(const Distance &, const real beta, const real rEq);
-std::valarray<real>
-    getFiniteForce(Distance, const real beta, const real rEq,
-                   const std::vector<real> &transitions);
+// Magnitude of law at module, along the distance from the miniboid to its
+// neighbor; 0 if not finite. No branch but selects, so it can be called from
+// vectorized loops.
+inline real
+    getFiniteForce(const ForceLaw &law, const real module, const real beta,
+                   const real rEq) {
+  const real evaluated = module <= law.elasticEnd ? module : law.plateau;
+  const real scalar    = (1.0f - evaluated / rEq) * beta;
+  return std::isfinite(scalar) ? scalar : 0.0f;
+}
@@ -10,7 +10,6 @@
 #include <sstream>
 #include <stdexcept>
 #include <thread>
-#include <valarray>
 #include <vector>
 
 #include "Date.hpp"
@@ -24,12 +23,11 @@ void
   std::ofstream &neiFile = NeighborPrint::file();
   const char TAB         = '\t';
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
     
     neiFile << super.ID << TAB << super.type;
-    for (const auto &nei : super.cellNeighbors())
+    for (const auto &nei : super.cellNeighbors)
       neiFile << TAB << nei;
     neiFile << std::endl;
   }
@@ -80,26 +78,22 @@ void
     writeMSDHead(myFile);
   }
 
-  super_int activatedNo = 0u;
-  for (auto &super : superboids)
-    if (super.isActivated() == true)
-      ++activatedNo;
+  const super_int activatedNo = Superboid::activated().size();
 
   uint16_t activated = static_cast<uint16_t>(activatedNo);
   myFile.write(reinterpret_cast<char *>(&activated), sizeof(activated));
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
-    const std::valarray<real> &position = super.miniboids[0u].position;
-    for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim) {
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
+    const ParticleVector &position = super.miniboids[0u].position;
+    for (dimension_int dim = 0u; dim < position.size(); ++dim) {
       float dComp = static_cast<float>(position[dim]);
       myFile.write(reinterpret_cast<char *>(&dComp), sizeof(dComp));
     }
 
     uint16_t type = static_cast<uint16_t>(super.type);
     myFile.write(reinterpret_cast<char *>(&type), sizeof(type));
-    uint16_t neiNo = static_cast<uint16_t>(super.cellNeighbors().size());
+    uint16_t neiNo = static_cast<uint16_t>(super.cellNeighbors.size());
     myFile.write(reinterpret_cast<char *>(&neiNo), sizeof(neiNo));
     float coreSize = static_cast<float>(parameters().PRINT_CORE);
     myFile.write(reinterpret_cast<char *>(&coreSize), sizeof(coreSize));
@@ -121,15 +115,10 @@ void
 
 void
     plainPrint(std::ofstream &myFile, std::vector<Superboid> &superboids) {
-  const char TAB        = '\t';
-  super_int activatedNo = 0u;
-  for (auto &super : superboids)
-    if (super.isActivated() == true)
-      ++activatedNo;
+  const char TAB = '\t';
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
     for (const auto &mini : super.miniboids) {
       float coreSize
@@ -137,7 +126,7 @@ void
                                             : parameters().PRINT_CORE);
       myFile.precision(8);
       myFile << std::fixed << mini.position << mini.velocity << super.type
-             << TAB << super.cellNeighbors().size() << TAB << coreSize
+             << TAB << super.cellNeighbors.size() << TAB << coreSize
              << std::endl;
     }
   }
@@ -157,29 +146,25 @@ void
     writeBinPrintHead(myFile);
   }
 
-  super_int activatedNo = 0u;
-  for (auto &super : superboids)
-    if (super.isActivated() == true)
-      ++activatedNo;
+  const super_int activatedNo = Superboid::activated().size();
 
   uint16_t activated = static_cast<uint16_t>(
       activatedNo * parameters().MINIBOIDS_PER_SUPERBOID);
   myFile.write(reinterpret_cast<char *>(&activated), sizeof(activated));
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
     for (const auto &mini : super.miniboids) {
-      const std::valarray<real> &position = mini.position;
-      for (dimension_int dim = 0u; dim < parameters().DIMENSIONS; ++dim) {
+      const ParticleVector &position = mini.position;
+      for (dimension_int dim = 0u; dim < position.size(); ++dim) {
         float dComp = static_cast<float>(position[dim]);
         myFile.write(reinterpret_cast<char *>(&dComp), sizeof(dComp));
       }
 
       uint16_t type = static_cast<uint16_t>(super.type);
       myFile.write(reinterpret_cast<char *>(&type), sizeof(type));
-      uint16_t neiNo = static_cast<uint16_t>(super.cellNeighbors().size());
+      uint16_t neiNo = static_cast<uint16_t>(super.cellNeighbors.size());
       myFile.write(reinterpret_cast<char *>(&neiNo), sizeof(neiNo));
       float coreSize
           = static_cast<float>(mini.ID == 0 ? (3.0 * parameters().PRINT_CORE)
@@ -207,15 +192,11 @@ void
   std::ofstream binaryOutFile(fileName.c_str(),
                               std::ofstream::out | std::ofstream::binary);
   binaryOutFile << step << std::endl;
-  super_int activatedCellsNo = 0;
-  for (const auto &super : superboids)
-    if (super.isActivated() == true)
-      ++activatedCellsNo;
+  const super_int activatedCellsNo = Superboid::activated().size();
 
   binaryOutFile << activatedCellsNo << std::endl;
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
     binaryOutFile << super.type << std::endl;
     for (auto &mini : super.miniboids) {
@@ -232,10 +213,9 @@ void
 
 void
     exportPhi(std::ofstream &file, const std::vector<Superboid> &superboids) {
-  std::valarray<real> meanArray(-0.0, parameters().DIMENSIONS);
-  for (const auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  Vec2 meanArray(-0.0f);
+  for (const auto superID : Superboid::activated()) {
+    const auto &super = superboids[superID];
 
     meanArray += super.miniboids[0u].velocity
                  / (parameters().SUPERBOIDS * parameters().SPEED[super.type]);
@@ -252,11 +232,10 @@ void
 
 void
     SCS::write(const step_int step, const std::vector<Superboid> &superboids) {
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
-    std::valarray<real> peripheralsCM(-0.0, parameters().DIMENSIONS);
+    Vec2 peripheralsCM(-0.0f);
     const mini_int PERIPHERAL_NO = parameters().MINIBOIDS_PER_SUPERBOID - 1;
     for (auto &mini : super.miniboids) {
       if (mini.ID == 0)
@@ -266,7 +245,8 @@ void
     peripheralsCM /= static_cast<real>(PERIPHERAL_NO);
 
     SCS::file() << std::fixed << step << '\t' << super.ID << '\t'
-                << getModule(super.miniboids[0u].position, peripheralsCM)
+                << getModule(Vec2(super.miniboids[0u].position),
+                             peripheralsCM)
                 << std::endl;
   }
   return;
@@ -281,9 +261,8 @@ void
   infiniteFile << '#' << std::endl;
   infinite2File << '#' << std::endl;
   virtFile << '#' << std::endl;
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
     for (const auto &va : super.infiniteVectors)
       infiniteFile << va << std::endl;
@@ -2,42 +2,32 @@
 // Copyright (C) 2018 Leonardo Gregory Brunnet.
 // License specified in LICENSE file.
 
-#include <random>
-#include <ctime>
-
 #include "initial.hpp"
 #include "Stokes.hpp"
+#include "random.hpp"
 
-static std::valarray<real>
+static Vec2
     initialNoise(const real radius) {
-  static std::default_random_engine defaultEngine(std::time(NULL));
-  static std::mt19937 mtEngine(defaultEngine());
-  std::uniform_real_distribution<real> uniDistribution2pi(0.0, TWO_PI);
-  std::uniform_real_distribution<real> uniDistributionRadius(0.0, radius);
-  std::valarray<real> _noise(parameters().DIMENSIONS);
-  if (parameters().DIMENSIONS == 2) {
-    const real r = std::sqrt(uniDistributionRadius(mtEngine));
-    const real a = uniDistribution2pi(mtEngine);
-    _noise[X]    = r * std::cos(a);
-    _noise[Y]    = r * std::sin(a);
-  } else {
-    std::cerr << "Not yet implemented." << std::endl << std::endl;
-  }
-  return _noise;
+  static uint64_t draws = 0u;
+  const RandomWords words
+      = getRandomWords(RandomStream::INITIAL_POSITION, draws++, 0u);
+  const real r = std::sqrt(radius * getUniform(words[0u]));
+  const real a = TWO_PI * getUniform(words[1u]);
+  return Vec2(r * std::cos(a), r * std::sin(a));
 }
 
-std::valarray<real>
+Vec2
     getCentralMiniboidPosition(void) {
   static super_int superboidCount    = 0u;
   static super_int superboidsOnLayer = 1u;
   static uint16_t layerCount         = 0u;
-  static std::valarray<real> nextPosition(0.0f, parameters().DIMENSIONS);
+  static Vec2 nextPosition;
   static real angle             = 0.0f;
   static const real DISTANCE    = parameters().INITIAL_DISTANCE;
   static const real DELTA_ANGLE = PI / 3.0f;
 
-  const std::valarray<real> position(
-      nextPosition + initialNoise(parameters().CORE_DIAMETER / 2.0f));
+  const Vec2 position(nextPosition
+                      + initialNoise(parameters().CORE_DIAMETER / 2.0f));
 
   if (superboidCount == (superboidsOnLayer - 1u)) {
     angle          = 0.0;
@@ -62,7 +52,7 @@ std::valarray<real>
 bool
     tryArrangeCell(Miniboid& mini) {
   bool ready = true;
-  for (dimension_int dim = 0u; ready && dim < parameters().DIMENSIONS; ++dim) {
+  for (dimension_int dim = 0u; ready && dim < Vec2::DIMENSIONS; ++dim) {
     const real comp       = mini.position[dim];
     const real HALF_RANGE = parameters().RANGE / 2.0f;
     if (HALF_RANGE - std::fabs(comp)
@@ -8,5 +8,5 @@
 bool
     tryArrangeCell(Miniboid&);
 
-std::valarray<real>
+Vec2
     getCentralMiniboidPosition(void);
\ No newline at end of file
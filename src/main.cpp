@@ -12,8 +12,10 @@
 #include "Box.hpp"
 #include "Date.hpp"
 #include "Parameter.hpp"
+#include "Particles.hpp"
 #include "Stokes.hpp"
 #include "Superboid.hpp"
+#include "ThreadPool.hpp"
 #include "export.hpp"
 #include "load.hpp"
 #include "nextstep.hpp"
@@ -56,9 +58,8 @@ static void
 
   super_int cellsActivatedNo = 0;
   std::vector<super_int> activatedPerType(p.TYPES_NO, 0);
-  for (const auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    const auto &super = superboids[superID];
     ++activatedPerType[super.type];
     ++cellsActivatedNo;
 
@@ -133,9 +134,8 @@ static void
   std::vector<real> msdRatioVec(p.TYPES_NO, -0.0f);
   std::vector<real> msdAreaVec(p.TYPES_NO, -0.0f);
 
-  for (const auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    const auto &super = superboids[superID];
 
     msdPerimeter += square(super.perimeter - meanPerimeter);
     msdArea += square(super.area - meanArea);
@@ -195,44 +195,43 @@ void
   parametersFile << getParameters() << std::endl;
   parametersFile.close();
 
+  Particles::allocate(p.MAX_SUPERBOIDS * p.MINIBOIDS_PER_SUPERBOID);
   std::vector<Superboid> superboids(p.MAX_SUPERBOIDS);
   for (super_int index = 0u; index < p.SUPERBOIDS; ++index)
     superboids[index].activate();
-  for (const auto &hole : parameters().STOKES_HOLES)
-    for (auto &super : superboids)
-      if (super.isActivated())
-        for (const auto &mini : super.miniboids)
-          if (hole.contains(mini.position)) {
-            super.setDeactivation("Began inside hole");
-            super.deactivate();
-            break;
-          }
+  for (const auto &hole : parameters().STOKES_HOLES) {
+    const std::vector<super_int> activated = Superboid::activated();  // Copy.
+    for (const auto superID : activated) {
+      auto &super = superboids[superID];
+      for (const auto &mini : super.miniboids)
+        if (hole.contains(mini.position)) {
+          super.setDeactivation("Began inside hole");
+          super.deactivate();
+          break;
+        }
+    }
+  }
 
   if (InitialPositions::load())
     loadPositions(superboids);
 
+  ThreadPool pool(p.THREADS);
+
   std::vector<Box> boxes(p.BOXES);
   for (auto &box : boxes)
     box.setNeighbors(boxes);
 
-  for (auto &super : superboids)
-    if (super.isActivated() == true)
-      for (auto &mini : super.miniboids)
-        mini.checkLimits();
+  for (const auto superID : Superboid::activated())
+    for (auto &mini : superboids[superID].miniboids)
+      mini.checkLimits();
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
-    for (auto &mini : super.miniboids)
-      boxes[Box::getBoxID(mini.position)].append(mini);
-  }
+  Box::fill(pool, boxes, superboids);
 
   if (p.BC == BoundaryCondition::PERIODIC)
     correctPositionAndRotation(superboids);
 
-  for (auto &super : superboids) {
-    if (super.isActivated() == false)
-      continue;
+  for (const auto superID : Superboid::activated()) {
+    auto &super = superboids[superID];
 
     for (auto &mini : super.miniboids)
       mini.reset();
@@ -242,6 +241,7 @@ void
 
   step_int continuousStep = 0llu;
   step_int nextExitStep   = InitialPositions::startStep();
+  step_int lastExitStep   = InitialPositions::startStep();
 
   std::ofstream phiFile;
   if (Phi::write())
@@ -289,12 +289,33 @@ void
         exportVirtuals = true;
     if (step == nextExitStep || step == p.STEPS || step == 0u) {
       std::cerr << "Step: " << step << std::endl;  ////
+      if (step > lastExitStep) {
+        const real overhead     = pool.popOverhead();
+        const step_int phasesNo = pool.popPhasesNo();
+        std::cerr << "Thread overhead: "
+                  << 1.0e6f * overhead / (step - lastExitStep)
+                  << " us/step (" << phasesNo / (step - lastExitStep)
+                  << " phases/step)" << std::endl;
+        std::cerr << "Thread imbalance: " << pool.popImbalance() << std::endl;
+        if (p.VERLET_SKIN > 0.0f) {
+          step_int rebuildsNo, stepsNo;
+          popVerletRebuilds(rebuildsNo, stepsNo);
+          std::cerr << "Verlet rebuilds: " << rebuildsNo << " in " << stepsNo
+                    << " steps" << std::endl;
+        }
+        step_int hitsNo, rejectsNo;
+        Superboid::popBoundingChecks(superboids, hitsNo, rejectsNo);
+        std::cerr << "Bounding circles (Verlet, segment and fan searches): "
+                  << hitsNo << " hits, " << rejectsNo << " rejects"
+                  << std::endl;
+        lastExitStep = step;
+      }
       exportLastPositionsAndVelocities(superboids, step);
       if (false)  // count cell neighbors.
       {
         super_int countNeighbors = 0u;
-        for (auto &super : superboids)
-          countNeighbors += super.cellNeighbors().size();
+        for (const auto superID : Superboid::activated())
+          countNeighbors += superboids[superID].cellNeighbors.size();
         std::cout << step << '\t'
                   << static_cast<real>(countNeighbors)
                          / static_cast<real>(p.SUPERBOIDS)
@@ -337,8 +358,8 @@ void
       }
     }
 
-    auto error = nextStep(boxes, superboids, step, shape, gamma, checkVirtuals,
-                          exportVirtuals);
+    auto error = nextStep(pool, boxes, superboids, step, shape, gamma,
+                          checkVirtuals, exportVirtuals);
     if (error != error::NextStepError::OK) {
       keepStepLoop = false;
       std::cerr << "this program will die soon. ";
@@ -352,12 +373,14 @@ void
     if (gamma == true) {
       real meanGamma     = -0.0f;
       super_int divideBy = 0u;
-      for (auto &super : superboids)
+      for (const auto superID : Superboid::activated()) {
+        const Superboid &super = superboids[superID];
         if (super.type == 0)
           if (super.doUseGamma == true) {
             meanGamma += super.gamma;
             ++divideBy;
           }
+      }
       meanGamma /= divideBy;
 
       gammaFile << std::fixed << step << '\t' << meanGamma << std::endl;
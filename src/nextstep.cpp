@@ -4,203 +4,196 @@
 
 #include "nextstep.hpp"
 
-#include <thread>
-#include <valarray>
 
+#include "PairSearch.hpp"
+#include "Schedule.hpp"
 #include "Superboid.hpp"
 #include "divide.hpp"
 #include "export.hpp"
 #include "parameters.hpp"
 
+// Run a phase over every activated cell, each thread grabbing chunks of
+// the schedule until none is left.
+template<typename Function>
 static void
-    nextVelocity(const thread_int THREAD_ID, std::vector<Superboid> &superboids,
-                 const step_int STEP) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    for (auto &mini : superboid.miniboids)
-      mini.setNextVelocity(STEP);
-  }
+    runPhase(ThreadPool &pool, const char *phase, Schedule &schedule,
+             std::vector<Superboid> &superboids, const Function &function) {
+  schedule.rewind();
+  pool.run(phase, [&](const thread_int) {
+    std::size_t begin, end;
+    while (schedule.next(begin, end))
+      for (std::size_t index = begin; index < end; ++index)
+        function(superboids[schedule[index]]);
+  });
 
   return;
 }
 
+// Same as runPhase, for functions that also need the thread ID.
+template<typename Function>
 static void
-    nextPosition(const thread_int THREAD_ID, std::vector<Superboid> &superboids,
-                 const step_int step) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.setNextPosition(step);
-  }
+    runThreadPhase(ThreadPool &pool, const char *phase, Schedule &schedule,
+                   std::vector<Superboid> &superboids,
+                   const Function &function) {
+  schedule.rewind();
+  pool.run(phase, [&](const thread_int THREAD_ID) {
+    std::size_t begin, end;
+    while (schedule.next(begin, end))
+      for (std::size_t index = begin; index < end; ++index)
+        function(THREAD_ID, superboids[schedule[index]]);
+  });
 
   return;
 }
 
 static void
-    nextBackInTime(const thread_int THREAD_ID,
-                   std::vector<Superboid> &superboids, const step_int step) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.checkBackInTime(step);
-  }
+    nextVelocity(Superboid &superboid, const step_int STEP) {
+  superboid.setNextVelocity(STEP);
 
   return;
 }
 
 static void
-    nextNeighbors(const thread_int THREAD_ID,
-                  std::vector<Superboid> &superboids, const step_int step) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    for (auto &mini : superboid.miniboids)
-      mini.setNeighbors(step);  // Search for neighbors.
-
-    superboid.miniboids[0].killBlackHoles();
-  }
+    nextPosition(Superboid &superboid, const step_int step) {
+  superboid.setNextPosition(step);
+
+  return;
+}
+
+static void
+    nextBackInTime(Superboid &superboid, const step_int step) {
+  superboid.checkBackInTime(step);
+
+  return;
+}
+
+static void
+    nextVerletCandidates(Superboid &superboid) {
+  for (auto &mini : superboid.miniboids)
+    mini.setVerletCandidates();
 
   return;
 }
 
 static void
-    nextCheckNeighbors(const thread_int THREAD_ID,
-                       std::vector<Superboid> &superboids) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.checkWrongNeighbors(superboids);
+    nextLimits(Superboid &superboid, const step_int step) {
+  for (auto &mini : superboid.miniboids) {
+    mini.checkLimits(step);
+    mini.clearNeighbors();
   }
+  if (parameters().VERLET_SKIN > 0.0f)
+    superboid.setVerletDisplacement();
+  superboid.setGeometry();
+
+  return;
+}
+
+static void
+    nextNeighbors(Superboid &superboid) {
+  superboid.miniboids[0].killBlackHoles();
+  superboid.setWorkload();
+
+  return;
+}
+
+static void
+    nextCheckNeighbors(Superboid &superboid,
+                       const std::vector<Superboid> &superboids) {
+  superboid.checkWrongNeighbors(superboids);
 
   return;
 }
 
 static void
-    nextVirtuals(const thread_int THREAD_ID, std::vector<Superboid> &superboids,
+    nextVirtuals(const thread_int THREAD_ID, Superboid &superboid,
                  const bool export_, const step_int step) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.checkVirtual(export_, step);
-  }
+  superboid.checkVirtual(THREAD_ID, export_, step);
+  for (auto &mini : superboid.virtualMiniboids())
+    mini.checkLimits(step);
 
   return;
 }
 
 static void
-    nextReset(const thread_int THREAD_ID, std::vector<Superboid> &superboids,
-              const bool shape, const step_int STEP) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.reset();
-    if (shape)
-      superboid.setShape(STEP);
-  }
+    nextReset(Superboid &superboid, const bool shape, const step_int STEP) {
+  superboid.reset();
+  if (shape)
+    superboid.setShape(STEP);
 
   return;
 }
 
 static void
-    nextBoxes(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
-              const step_int step) {
-  for (auto &super : superboids) {
-    if (super.isActivated() == true) {
-      for (auto &mini : super.miniboids) {
-        mini.checkLimits(step);
-        const box_int newBoxID = Box::getBoxID(mini.position);
-        const box_int oldBoxID = mini.boxID();
-        if (oldBoxID != newBoxID) {
-          boxes[oldBoxID].remove(mini);
-          boxes[newBoxID].append(mini);
-        }
-      }
-    }
-  }
+    nextBoxLimits(Superboid &superboid, const step_int step) {
+  for (auto &mini : superboid.miniboids)
+    mini.checkLimits(step);
+  superboid.clearVirtualMiniboids();
 
-  for (auto &box : boxes) {
-    const std::list<const Miniboid *> miniboids = box.miniboids;
-    for (const auto &mini : miniboids)
-      if (mini->isVirtual)
-        box.remove(*mini);
-  }
+  return;
+}
 
-  for (auto &super : superboids)
-    super.virtualMiniboids.clear();
+static void
+    nextBoxes(ThreadPool &pool, std::vector<Superboid> &superboids,
+              const step_int step) {
+  // Division may have changed the activated superboids since the schedule
+  // was set, so they are shared here by index.
+  const std::vector<super_int> &activated = Superboid::activated();
+  pool.run("boxLimits", [&](const thread_int THREAD_ID) {
+    for (std::size_t index = THREAD_ID; index < activated.size();
+         index += pool.size())
+      nextBoxLimits(superboids[activated[index]], step);
+  });
+
+  // The real layer is sorted again by nextBoxes_putVirtuals, after the
+  // positions are corrected at the beginning of the next step.
+  Box::clearVirtuals();
 
   return;
 }
 
 void
-    nextBoxes(std::vector<Box> &boxes, Superboid &super, const step_int step) {
+    nextBoxes(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+              Superboid &super, const step_int step) {
   if (super.isActivated() == true)
-    for (auto &mini : super.miniboids) {
+    for (auto &mini : super.miniboids)
       mini.checkLimits(step);
-      const box_int newBoxID = Box::getBoxID(mini.position);
-      const box_int oldBoxID = mini.boxID();
-      if (oldBoxID != newBoxID) {
-        boxes[oldBoxID].remove(mini);
-        boxes[newBoxID].append(mini);
-      }
-    }
 
   super.clearVirtualMiniboids();
 
+  // Virtual miniboids of the other superboids stay in the boxes.
+  Box::fill(boxes, superboids, true);
+
   return;
 }
 
+// Virtual miniboids were put inside the limits by nextVirtuals.
 static void
-    nextBoxes_putVirtuals(std::vector<Box> &boxes,
-                          std::vector<Superboid> &superboids,
-                          const step_int step) {
-  for (auto &super : superboids) {
-    for (auto &mini : super.virtualMiniboids) {
-      mini.checkLimits(step);
-      const box_int newBoxID = Box::getBoxID(mini.position);
-      boxes[newBoxID].append(mini);
-    }
-  }
+    nextBoxes_putVirtuals(ThreadPool &pool, std::vector<Box> &boxes,
+                          std::vector<Superboid> &superboids) {
+  Box::fill(pool, boxes, superboids);
+  if (parameters().CONTACT == Contact::VIRTUAL)
+    Box::fillVirtuals(pool, boxes, superboids);
+  else
+    Box::fillSegments(pool, boxes, superboids);
 
   return;
 }
 
 static void
-    nextGamma(const thread_int THREAD_ID, std::vector<Superboid> &superboids) {
-  for (auto &superboid : superboids) {
-    if (superboid.ID % parameters().THREADS != THREAD_ID)
-      continue;
-    if (superboid.isActivated() == false)
-      continue;
-    superboid.setGamma(superboids);
-  }
+    nextGamma(Superboid &superboid, std::vector<Superboid> &superboids) {
+  superboid.setGamma(superboids);
 
   return;
 }
 
-static std::valarray<real>
+static Vec2
     getMeanPosition(const std::vector<Superboid> &superboids) {
-  std::valarray<real> mean(parameters().DIMENSIONS);
+  Vec2 mean;
   super_int divideBy = 0u;
-  for (const auto &super : superboids)
-    if (super.isActivated() == true) {
-      ++divideBy;
-      mean += super.miniboids[0u].position;
-    }
+  for (const auto superID : Superboid::activated()) {
+    ++divideBy;
+    mean += superboids[superID].miniboids[0u].position;
+  }
   mean /= divideBy;
 
   return mean;
@@ -208,17 +201,51 @@ static std::valarray<real>
 
 void
     correctPositionAndRotation(std::vector<Superboid> &superboids) {
-  const std::valarray<real> meanPosition = getMeanPosition(superboids);
-  for (auto &super : superboids)
-    if (super.isActivated() == true)
-      for (auto &mini : super.miniboids)
-        mini.position -= meanPosition;
+  const Vec2 meanPosition = getMeanPosition(superboids);
+  for (const auto superID : Superboid::activated())
+    for (auto &mini : superboids[superID].miniboids) {
+      mini.position -= meanPosition;
+      mini.shiftVerletPosition(-meanPosition);
+    }
+}
+
+static step_int verletRebuildsNo = 0u;
+static step_int verletStepsNo    = 0u;
+
+// Verlet candidates must be set again when some miniboid may have crossed the
+// skin, i.e. moved more than half of it, or when superboids were activated
+// or deactivated (death and division).
+static bool
+    needVerletRebuild(const std::vector<Superboid> &superboids) {
+  static std::vector<super_int> lastActivated;
+  if (lastActivated != Superboid::activated()) {
+    lastActivated = Superboid::activated();
+    return true;
+  }
+
+  for (const auto superID : Superboid::activated())
+    if (superboids[superID].verletDisplacement()
+        > 0.5f * parameters().VERLET_SKIN)
+      return true;
+
+  return false;
+}
+
+void
+    popVerletRebuilds(step_int &rebuildsNo, step_int &stepsNo) {
+  rebuildsNo       = verletRebuildsNo;
+  stepsNo          = verletStepsNo;
+  verletRebuildsNo = 0u;
+  verletStepsNo    = 0u;
+
+  return;
 }
 
 error::NextStepError
-    nextStep(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
-             const step_int step, const bool shape, const bool gamma,
-             const bool checkVirt, const bool exportVirt) {
+    nextStep(ThreadPool &pool, std::vector<Box> &boxes,
+             std::vector<Superboid> &superboids, const step_int step,
+             const bool shape, const bool gamma, const bool checkVirt,
+             const bool exportVirt) {
 #if 1
   if (parameters().BC == BoundaryCondition::PERIODIC)
     correctPositionAndRotation(superboids);
@@ -230,108 +257,93 @@ error::NextStepError
     neighborsPrint(superboids);
 
   {
-    for (auto &super : superboids)
-      if (super.willDie())
-        super.deactivate();
-  }
-
-  if (gamma) {
-    static std::vector<std::thread> gammaThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      gammaThreads[threadCount]
-          = std::thread(nextGamma, threadCount, std::ref(superboids));
-    for (auto &thread : gammaThreads)
-      thread.join();
-  }
-
-  {
-    static std::vector<std::thread> resetThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      resetThreads[threadCount] = std::thread(
-          nextReset, threadCount, std::ref(superboids), shape, step);
-    for (auto &thread : resetThreads)
-      thread.join();
+    const std::vector<super_int> activated = Superboid::activated();  // Copy.
+    for (const auto superID : activated)
+      if (superboids[superID].willDie())
+        superboids[superID].deactivate();
   }
 
-  {
-    static std::vector<std::thread> virtualThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      virtualThreads[threadCount] = std::thread(
-          nextVirtuals, threadCount, std::ref(superboids), exportVirt, step);
-    for (auto &thread : virtualThreads)
-      thread.join();
-  }
-
-  nextBoxes_putVirtuals(boxes, superboids, step);
-
-  {
-    static std::vector<std::thread> neighborsThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      neighborsThreads[threadCount]
-          = std::thread(nextNeighbors, threadCount, std::ref(superboids), step);
-    for (auto &thread : neighborsThreads)
-      thread.join();
-  }
-
-  {
-    static std::vector<std::thread> checkNeighborsThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      checkNeighborsThreads[threadCount]
-          = std::thread(nextCheckNeighbors, threadCount, std::ref(superboids));
-    for (auto &thread : checkNeighborsThreads)
-      thread.join();
-  }
-
-  {
-    static std::vector<std::thread> velocityThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      velocityThreads[threadCount]
-          = std::thread(nextVelocity, threadCount, std::ref(superboids), step);
-    for (auto &thread : velocityThreads)
-      thread.join();
-  }
+  static Schedule schedule;
+  schedule.set(superboids, pool.size());
+
+  // Up to the boxes, a cell only writes itself and reads the types of the
+  // others, so it runs in one pass. Gamma reads the neighbors of the last
+  // step before reset clears them, and the limits come after the shape and
+  // the virtual miniboids, which are computed from the corrected positions.
+  if (parameters().CONTACT == Contact::VIRTUAL)
+    Superboid::clearVirtualPools(pool.size());
+  runThreadPhase(pool, "cells", schedule, superboids,
+                 [&](const thread_int THREAD_ID, Superboid &superboid) {
+                   if (gamma)
+                     nextGamma(superboid, superboids);
+                   nextReset(superboid, shape, step);
+                   if (parameters().CONTACT == Contact::VIRTUAL)
+                     nextVirtuals(THREAD_ID, superboid, exportVirt, step);
+                   else
+                     superboid.checkSegments();
+                   nextLimits(superboid, step);
+                 });
+
+  nextBoxes_putVirtuals(pool, boxes, superboids);
+
+  static PairSearch pairSearch;
+  pairSearch.set(pool.size());
+  if (parameters().VERLET_SKIN > 0.0f) {
+    ++verletStepsNo;
+    if (needVerletRebuild(superboids)) {
+      ++verletRebuildsNo;
+      runPhase(pool, "verletBuild", schedule, superboids,
+               [&](Superboid &superboid) { nextVerletCandidates(superboid); });
+    }
+    runThreadPhase(pool, "pairs", schedule, superboids,
+                   [&](const thread_int THREAD_ID, Superboid &superboid) {
+                     pairSearch.searchCandidates(THREAD_ID, superboid);
+                   });
+  } else
+    pool.run("pairs", [&](const thread_int THREAD_ID) {
+      pairSearch.searchBoxes(THREAD_ID, boxes);
+    });
+  if (parameters().CONTACT == Contact::SEGMENT)
+    runThreadPhase(pool, "segmentPairs", schedule, superboids,
+                   [&](const thread_int THREAD_ID, Superboid &superboid) {
+                     pairSearch.searchSegments(THREAD_ID, superboid);
+                   });
+  pool.run("scatter", [&](const thread_int THREAD_ID) {
+    pairSearch.scatter(THREAD_ID, superboids);
+  });
+
+  // The velocities read the positions, velocities and geometry of the other
+  // cells, none of which is written until the next phase.
+  runPhase(pool, "velocity", schedule, superboids, [&](Superboid &superboid) {
+    nextNeighbors(superboid);
+    nextCheckNeighbors(superboid, superboids);
+    nextVelocity(superboid, step);
+  });
 
   if (checkVirt)
-    for (const auto &super : superboids) {
-      if (super.isActivated() == false)
-        continue;
-      const size_t s = super.virtualMiniboids.size();
+    for (const auto superID : Superboid::activated()) {
+      const size_t s = superboids[superID].virtualMiniboids().size();
       if (s > 4 * parameters().MINIBOIDS_PER_SUPERBOID)
         return error::NextStepError::TOO_MANY_VIRTUALS_SINGLE_CELL;
     }
 
-  {
-    static std::vector<std::thread> positionThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      positionThreads[threadCount]
-          = std::thread(nextPosition, threadCount, std::ref(superboids), step);
-    for (auto &thread : positionThreads)
-      thread.join();
-  }
-
-  {
-    static std::vector<std::thread> backThreads(parameters().THREADS);
-    for (thread_int threadCount = 0u; threadCount < parameters().THREADS;
-         ++threadCount)
-      backThreads[threadCount] = std::thread(nextBackInTime, threadCount,
-                                             std::ref(superboids), step);
-    for (auto &thread : backThreads)
-      thread.join();
-  }
-
-  if (parameters().DIVISION_INTERVAL != 0u)
-    if (step % parameters().DIVISION_INTERVAL
-        == parameters().DIVISION_INTERVAL - 1)
-      divide(boxes, superboids, step);
-
-  nextBoxes(boxes, superboids, step);
+  const bool dividing = parameters().DIVISION_INTERVAL != 0u
+                        && step % parameters().DIVISION_INTERVAL
+                               == parameters().DIVISION_INTERVAL - 1;
+
+  // Division reads every cell, so the limits wait for it only when it runs.
+  runPhase(pool, "position", schedule, superboids, [&](Superboid &superboid) {
+    nextPosition(superboid, step);
+    nextBackInTime(superboid, step);
+    if (!dividing)
+      nextBoxLimits(superboid, step);
+  });
+
+  if (dividing) {
+    divide(boxes, superboids, step);
+    nextBoxes(pool, superboids, step);
+  } else
+    Box::clearVirtuals();
 
   return error::NextStepError::OK;
 }
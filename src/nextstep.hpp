@@ -8,6 +8,7 @@
 
 #include "Box.hpp"
 #include "Superboid.hpp"
+#include "ThreadPool.hpp"
 
 namespace error {
   enum class NextStepError {
@@ -18,10 +19,14 @@ namespace error {
 }
 
 extern error::NextStepError
-    nextStep(std::vector<Box> &, std::vector<Superboid> &, const step_int,
-             const bool shape, const bool gamma, const bool checkVirt,
-             const bool exportVirt);
+    nextStep(ThreadPool &, std::vector<Box> &, std::vector<Superboid> &,
+             const step_int, const bool shape, const bool gamma,
+             const bool checkVirt, const bool exportVirt);
+// Verlet candidates rebuilds and steps since the last call.
+extern void
+    popVerletRebuilds(step_int &rebuildsNo, step_int &stepsNo);
 extern void
     correctPositionAndRotation(std::vector<Superboid> &superboids);
 extern void
-    nextBoxes(std::vector<Box> &boxes, Superboid &, const step_int);
+    nextBoxes(std::vector<Box> &boxes, std::vector<Superboid> &superboids,
+              Superboid &, const step_int);
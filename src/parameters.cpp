@@ -4,6 +4,7 @@
 
 #include "parameters.hpp"
 
+#include <ctime>
 #include <sstream>
 #include <iomanip>
 
@@ -199,6 +200,10 @@ std::string &
       std::cerr << std::endl << "UGLY CACACA" << std::endl << std::endl;
     stream << "# KILL"
            << "\t\t\t" << killCond << std::endl;
+    stream << "# CONTACT"
+           << "\t\t"
+           << (p.CONTACT == Contact::VIRTUAL ? "VIRTUAL" : "SEGMENT")
+           << std::endl;
 
     stream << "# Stokes holes:" << std::endl;
     for (const auto &hole : p.STOKES_HOLES)
@@ -289,9 +294,13 @@ std::string &
            << "\t\t\t" << p.DT << std::endl;
     stream << "# NEIGHBOR_DISTANCE"
            << "\t" << p.NEIGHBOR_DISTANCE << std::endl;
+    stream << "# VERLET_SKIN"
+           << "\t\t" << p.VERLET_SKIN << std::endl;
 
     stream << "# THREADS"
            << "\t\t" << p.THREADS << std::endl;
+    stream << "# SEED"
+           << "\t\t\t" << p.SEED << std::endl;
 
     s = stream.str();
   }
@@ -300,8 +309,10 @@ std::string &
 
 static box_int
     getBoxesInEdge() {
-  const box_int b
-      = getParameter<real>("domain") / getParameter<real>("neighbor_distance");
+  // Boxes must hold every Verlet candidate, not only actual neighbors.
+  const box_int b = getParameter<real>("domain")
+                    / (getParameter<real>("neighbor_distance")
+                       + getParameter<real>("verlet_skin"));
   if (b < 3)
     return 3;
   else
@@ -449,6 +460,16 @@ static KillCondition
     panic("kill must be either right, none, right_edge_or_p0, or p0");
 }
 
+static Contact
+    getContact(const std::string &c) {
+  if (c == "virtual")
+    return Contact::VIRTUAL;
+  else if (c == "segment")
+    return Contact::SEGMENT;
+  else
+    panic("contact must be either virtual or segment");
+}
+
 void
     Parameters::setDomain(void) {
   // Domain length:
@@ -471,6 +492,10 @@ void
   else if (this->NEIGHBOR_DISTANCE < this->REAL_TOLERANCE)
     panic("neighbor_distance supposed to be bigger", this->NEIGHBOR_DISTANCE);
 
+  this->VERLET_SKIN = getParameter<real>("verlet_skin");
+  if (this->VERLET_SKIN < 0.0)
+    panic("verlet_skin supposed to be non-negative", this->VERLET_SKIN);
+
   // sqrt(total boxes quantity):
   this->BOXES_IN_EDGE = getBoxesInEdge();
   // Total boxes quantity:
@@ -479,6 +504,7 @@ void
   this->BC                = getBC(getParameter<std::string>("boundary"));
   this->INITIAL_CONDITION = getIC(getParameter<std::string>("initial"));
   this->KILL_CONDITION    = getKC(getParameter<std::string>("kill"));
+  this->CONTACT           = getContact(getParameter<std::string>("contact"));
   this->P0_LIMIT          = getParameter<real>("p0_limit");
   if (this->P0_LIMIT < 3.545)
     panic("p0_limit should be greater than 3.545");
@@ -567,8 +593,8 @@ void
     panic("algorithm problem");
   const std::size_t stokesNo = vec.size() / (this->DIMENSIONS + 1);
   for (std::size_t stokesID = 0; stokesID < stokesNo; ++stokesID) {
-    std::valarray<real> position(this->DIMENSIONS);
-    for (dimension_int dim = 0; dim < this->DIMENSIONS; ++dim)
+    Vec2 position;
+    for (dimension_int dim = 0; dim < Vec2::DIMENSIONS; ++dim)
       position[dim] = vec[stokesID * (this->DIMENSIONS + 1) + 1 + dim];
     this->STOKES_HOLES.emplace_back(position,
                                     vec[stokesID * (this->DIMENSIONS + 1)]);
@@ -623,6 +649,15 @@ void
   this->THREADS
       = getParameter<unsigned long int>("threads");  // Threads quantity.
 
+  const auto &_seed = getParameter<std::string>("seed");
+  if (_seed == "time")
+    this->SEED = std::time(NULL);
+  else if (!_seed.empty()
+           && _seed.find_first_not_of("0123456789") == std::string::npos)
+    this->SEED = std::stoull(_seed);
+  else
+    panic("seed must be a non-negative integer or \"time\".");
+
   this->TARGET_AREA = getTargetAreas(this->RADIAL_REQ);
 
   this->HARRIS_AMOUNT = std::vector<mini_int>(this->TYPES_NO);
@@ -680,6 +715,69 @@ void
   for (type_int t = 0u; t < this->TYPES_NO; ++t)
     this->TANGENT_PLASTIC_END[t] *= arcs[t];
 
+  this->setForceLaws();
+  this->setTypePairs();
+
+  return;
+}
+
+// Largest real not above limit + 1.0e-6, that sum taken in double precision.
+static real
+    getElasticEnd(const real limit) {
+  const double end = limit + 1.0e-6;
+  real elasticEnd  = static_cast<real>(end);
+  if (elasticEnd > end)
+    elasticEnd = std::nextafter(elasticEnd, -INFINITY);
+  return elasticEnd;
+}
+
+void
+    Parameters::setForceLaws(void) {
+  const real INTER_END = getElasticEnd(this->INTER_ELASTIC_UP_LIMIT);
+
+  // In ForceKind order. The radial force stays elastic up to the inter-cell
+  // limit. The constant tangent regime is evaluated at the plastic begin,
+  // beyond the plastic end too.
+  this->FORCE_LAWS.clear();
+  for (type_int t = 0u; t < this->TYPES_NO; ++t)
+    this->FORCE_LAWS.push_back(
+        ForceLaw({INTER_END, this->INTER_ELASTIC_UP_LIMIT}));
+  for (type_int t = 0u; t < this->TYPES_NO; ++t)
+    this->FORCE_LAWS.push_back(
+        ForceLaw({INTER_END, this->INTER_ELASTIC_UP_LIMIT}));
+  for (type_int t = 0u; t < this->TYPES_NO; ++t) {
+    const real BEGIN = this->TANGENT_PLASTIC_BEGIN[t];
+    this->FORCE_LAWS.push_back(ForceLaw({BEGIN + 1.0e-6f, BEGIN}));
+  }
+
+  return;
+}
+
+void
+    Parameters::setTypePairs(void) {
+  const std::vector<const std::vector<std::vector<real>> *> matrices
+      = {&this->INTER_ALPHA, &this->INTER_BETA, &this->INTER_REQ,
+         &this->RADIAL_BETA, &this->KAPA,       &this->TANGENT_BETA};
+  for (const auto matrix : matrices) {
+    if (matrix->size() != this->TYPES_NO)
+      panic("interaction matrices must have a line per type",
+            matrix->size());
+    for (const auto &line : *matrix)
+      if (line.size() != this->TYPES_NO)
+        panic("interaction matrices must have a column per type",
+              line.size());
+  }
+
+  this->TYPE_PAIRS.clear();
+  for (type_int t1 = 0u; t1 < this->TYPES_NO; ++t1)
+    for (type_int t2 = 0u; t2 < this->TYPES_NO; ++t2)
+      this->TYPE_PAIRS.push_back(
+          TypePair({this->INTER_ALPHA[t1][t2], this->INTER_BETA[t1][t2],
+                    this->INTER_REQ[t1][t2],
+                    this->getForceLaw(ForceKind::INTER, t1),
+                    this->RADIAL_BETA[t1][t2], this->KAPA[t1][t2],
+                    this->TANGENT_BETA[t1][t2]}));
+
   return;
 }
 
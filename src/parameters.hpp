@@ -7,7 +7,6 @@
 #include <cstdint>
 #include <iostream>
 #include <string>
-#include <valarray>
 #include <vector>
 
 typedef uint16_t type_int;
@@ -24,6 +23,49 @@ class Stokes;
 enum class BoundaryCondition { PERIODIC, RECTANGLE, STOKES };
 enum class InitialCondition { HEX_CENTER, LEFT_EDGE };
 enum class KillCondition { NONE, RIGHT_EDGE, P0, RIGHT_EDGE_OR_P0 };
+// What closes the gaps between peripheral particles too far apart.
+enum class Contact { VIRTUAL, SEGMENT };
+// Interactions with a force law of their own, see ForceLaw.
+enum class ForceKind : uint16_t { INTER, RADIAL, TANGENT, KINDS_NO };
+
+// Piecewise force law of one kind of interaction and one cell type: elastic,
+// (1 - module / rEq) * beta, up to elasticEnd, then constant, as evaluated
+// at plateau. Beta and rEq change per miniboid and per step, so only the
+// breakpoints are kept.
+struct ForceLaw {
+  real elasticEnd;  // Tolerance included.
+  real plateau;
+};
+
+// Parameters of the interactions of a miniboid of one type with neighbors
+// of another type, packed so each pair is one load from one table.
+struct alignas(16) TypePair {
+  real interAlpha;
+  real interBeta;
+  real interReq;
+  ForceLaw interLaw;
+  // Harris weights of a neighbor of the other type.
+  real radialBeta;
+  real kapa;
+  real tangentBeta;
+};
+
+// Calls kernel<TYPES_NO>(...) for the usual 1, 2 and 3 types, kernel<0>
+// otherwise, so loops over the types can be unrolled.
+#define TYPES_KERNEL(kernel, ...)           \
+  switch (parameters().TYPES_NO) {          \
+    case 1u:                                \
+      kernel<1u>(__VA_ARGS__);              \
+      break;                                \
+    case 2u:                                \
+      kernel<2u>(__VA_ARGS__);              \
+      break;                                \
+    case 3u:                                \
+      kernel<3u>(__VA_ARGS__);              \
+      break;                                \
+    default:                                \
+      kernel<0u>(__VA_ARGS__);              \
+  }
 
 extern const real HALF_PI;
 extern const real PI;
@@ -39,6 +81,7 @@ class Parameters {
   BoundaryCondition BC;
   InitialCondition INITIAL_CONDITION;
   KillCondition KILL_CONDITION;
+  Contact CONTACT;
   real P0_LIMIT;
   std::vector<real> RECTANGLE_SIZE;
 
@@ -63,6 +106,7 @@ class Parameters {
   real RANGE;
 
   real NEIGHBOR_DISTANCE;
+  real VERLET_SKIN;  // 0 disables Verlet neighbor lists.
   real INTER_ELASTIC_UP_LIMIT;
   std::vector<real> RADIAL_PLASTIC_BEGIN;
   std::vector<real> RADIAL_PLASTIC_END;
@@ -108,9 +152,25 @@ class Parameters {
   real EXIT_FACTOR;
 
   thread_int THREADS;
+  uint64_t SEED;  // Of every random number, see random.hpp.
 
   real REAL_TOLERANCE;
 
+  std::vector<ForceLaw> FORCE_LAWS;  // [kind * TYPES_NO + type].
+  inline const ForceLaw &getForceLaw(const ForceKind kind,
+                                     const type_int type) const {
+    return this->FORCE_LAWS[static_cast<std::size_t>(kind) * this->TYPES_NO
+                            + type];
+  }
+  std::vector<TypePair> TYPE_PAIRS;  // [type * TYPES_NO + other type].
+  inline const TypePair *getTypePairs(const type_int type) const {
+    return this->TYPE_PAIRS.data() + type * this->TYPES_NO;
+  }
+  inline const TypePair &getTypePair(const type_int type,
+                                     const type_int other) const {
+    return this->getTypePairs(type)[other];
+  }
+
  protected:
   void set1(void);
   void setCells(void);
@@ -119,6 +179,8 @@ class Parameters {
   void setRadial(void);
   void setInter(void);
   void setStokes(void);
+  void setForceLaws(void);
+  void setTypePairs(void);
 
   real getDivisionDistance(void) const;
 };
@@ -153,14 +215,6 @@ real
   return std::sqrt(squareSum);
 };
 
-inline std::ostream &
-    operator<<(std::ostream &os, const std::valarray<real> &va) {
-  for (auto &component : va)
-    os << std::fixed << component << '\t';
-
-  return os;
-}
-
 extern const Parameters &
     parameters();
 extern std::string &
@@ -0,0 +1,71 @@
+// Copyright (C) 2016-2018 Cássio Kirch.
+// Copyright (C) 2018 Leonardo Gregory Brunnet.
+// License specified in LICENSE file.
+
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "parameters.hpp"
+
+// Counter-based random numbers: Philox 4x32 with 10 rounds (Salmon et al.,
+// Parallel random numbers: as easy as 1, 2, 3, 2011). A draw is a function
+// of the seed parameter, a stream and two counters only, so it depends
+// neither on the threads nor on the order of the draws.
+enum class RandomStream : uint32_t {
+  NOISE,             // Step, superboid and block of four miniboids.
+  SUPERBOID,         // Draws of each superboid, in their order.
+  DIVISION_CELL,     // Step and attempt.
+  DIVISION_TYPE,     // Step and superboid.
+  INITIAL_TYPE,      // Draws, in their order.
+  INITIAL_POSITION,  // Draws, in their order.
+};
+
+typedef std::array<uint32_t, 4u> RandomWords;
+
+inline void
+    multiplyPhilox(const uint32_t a, const uint32_t b, uint32_t &high,
+                   uint32_t &low) {
+  const uint64_t product = static_cast<uint64_t>(a) * b;
+  high                   = static_cast<uint32_t>(product >> 32);
+  low                    = static_cast<uint32_t>(product);
+
+  return;
+}
+
+// The high bits of first are folded with the stream, so steps repeat after
+// 2^24 times 2^32.
+inline RandomWords
+    getRandomWords(const RandomStream stream, const uint64_t first,
+                   const uint64_t second) {
+  RandomWords c = {{static_cast<uint32_t>(second),
+                    static_cast<uint32_t>(second >> 32),
+                    static_cast<uint32_t>(first),
+                    static_cast<uint32_t>(first >> 32)
+                        ^ (static_cast<uint32_t>(stream) << 24)}};
+  uint32_t key0 = static_cast<uint32_t>(parameters().SEED);
+  uint32_t key1 = static_cast<uint32_t>(parameters().SEED >> 32);
+
+  for (uint16_t round = 0u; round < 10u; ++round) {
+    uint32_t high0, low0, high1, low1;
+    multiplyPhilox(0xD2511F53u, c[0u], high0, low0);
+    multiplyPhilox(0xCD9E8D57u, c[2u], high1, low1);
+    c    = {{high1 ^ c[1u] ^ key0, low1, high0 ^ c[3u] ^ key1, low0}};
+    key0 += 0x9E3779B9u;
+    key1 += 0xBB67AE85u;
+  }
+
+  return c;
+}
+
+// In [0, 1), from the upper 24 bits.
+inline real
+    getUniform(const uint32_t word) {
+  return static_cast<real>(word >> 8) * (1.0f / 16777216.0f);
+}
+
+// In [0, n).
+inline uint32_t
+    getIndex(const uint32_t word, const uint32_t n) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(word) * n) >> 32);
+}